@@ -1,791 +1,2371 @@
-#include "E2PROM.h"
-
-const E2PROM_Driver* eepromDriver;
-static E2PROM* lastE2PROM = E2PROM_NULL;
-
-
-
-#define __eeprom()      lastE2PROM
-#define __next(E2PROM)  E2PROM = (E2PROM)->Previous
-
-
-
-/**
- * @brief this Array use for E2PROM Erase with 0xFF and u can change Value in the Configure  
- */
-static const uint8_t E2PROM_PAGE[] = {
-    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
-    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
-    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
-    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
-    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
-    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
-    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
-    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
-};
-
-
-
-
-
-/**
- * @brief initial the E2PROM Driver
- * @param driver
- */
-void E2PROM_driverInit(const E2PROM_Driver* driver) {
-    eepromDriver = driver;
-}
-
-
-
-/**
- * @brief  DeInitial the E2PROM Driver
- *
- * @param driver
- */
-void E2PROM_deInit(void) {
-    eepromDriver = NULL_DRIVER;
-}
-
-
-
-/**
- * @brief Set E2PROM Config
- *
- * @param eeprom
- * @param config
- */
-void E2PROM_setConfig(E2PROM* eeprom, const E2PROM_Config* config) {
-    eeprom->Config = config;
-}
-
-
-
-/**
- * @brief Erase the E2PROM
- *
- * @param eeprom
- * @return E2PROM_Result
- */
-void E2PROM_eraseBlocking(E2PROM* eeprom) {
-    eeprom->Lock  = 1;
-    uint16_t cnt  = eeprom->Config->Size;
-    uint16_t addr = 0;
-    while (cnt > 0) {
-        eepromDriver->write(eeprom, addr, (void*)E2PROM_PAGE, eeprom->Config->PageSize);
-        addr += eeprom->Config->PageSize;
-        cnt  -= eeprom->Config->PageSize;
-        eepromDriver->delayMs(eeprom->Config->WriteDelayTime);
-    }
-    eeprom->Lock = 0;
-}
-
-
-
-/**
- * @brief Erase the E2PROM with Noise Value
- *
- * @param eeprom  Address of your E2PROM
- * @return E2PROM_Result
- */
-void E2PROM_noiseEraseBlocking(E2PROM* eeprom) {
-    eeprom->Lock  = 1;
-    uint16_t cnt  = eeprom->Config->Size / 4;
-    uint16_t addr = 0;
-    uint32_t temp;
-    while (cnt > 0) {
-        temp = eepromDriver->rand();
-        eepromDriver->write(eeprom, addr, (uint8_t*)&temp, 4);
-        addr += 4;
-        cnt--;
-        eepromDriver->delayMs(eeprom->Config->WriteDelayTime);
-    }
-    eeprom->Lock = 0;
-}
-
-
-/**
- * @brief initial E2PROM , and u must init your E2PROM before use it
- *
- * @param eeprom            Address of your E2PROM
- * @param commandQBuffer    Address of Buffer u need for initial the CommandQueue
- * @param commandQLen       Length of Buffer, u must Enter sizeof(commandQBuffer)
- * @param qReadBuffer       Address of Buffer u need for initial the ReadQueue
- * @param qReadLen          Length of Buffer, u must Enter sizeof(qReadBuffer)
- * @param streamWriteBuffer Address of Buffer u need for initial the WriteStream
- * @param streamWriteLen    Length of Buffer, u must Enter sizeof(streamWriteBuffer)
- * @param streamReadBuffer  Address of Buffer u need for initial the ReadStream
- * @param streamReadLen     Length of Buffer, u must Enter sizeof(streamReadBuffer)
- */
-void E2PROM_init (E2PROM* eeprom, uint8_t* commandQBuffer, uint16_t commandQLen, uint8_t* qReadBuffer, uint16_t qReadLen, uint8_t* streamWriteBuffer, uint16_t streamWriteLen, uint8_t* streamReadBuffer, uint16_t streamReadLen) {
-    eeprom->NextTick                          = 0;
-    eeprom->Configured                        = 0;
-    eeprom->Lock                              = 0;
-    eeprom->CommandHeaderInProcess.Len        = 0;
-    eeprom->CommandHeaderInProcess.MemAddress = 0;
-    eeprom->CommandHeaderInProcess.Mode       = 0;
-    eeprom->CommandHeaderInProcess.Type       = 0;
-    eeprom->InTransmit                        = 0;
-    Queue_init(&eeprom->CommandQueue, commandQBuffer, commandQLen, sizeof(E2PROM_CommandHeader));
-    Queue_init(&eeprom->ReadQueue, qReadBuffer, qReadLen, sizeof(E2PROM_CommandHeader));
-    Stream_init(&eeprom->WriteStream, streamWriteBuffer, streamWriteLen);
-    Stream_init(&eeprom->ReadStream, streamReadBuffer, streamReadLen);
-  
-}
-
-#if E2PROM_NOISE_ERASE_NON_BLOCKING
-/**
- * @brief if u want to use NonBlocking NoiseErase u must use this function and after this u can use E2PROM_noiseErase
- *
- * @param eeprom Address of your E2PROM
- * @param streamBuffer address of buffer for init NoiseEraseStream
- * @param len Length of Buffer, sizeof(streamBuffer)
- */
-void E2PROM_noiseEraseInit(E2PROM* eeprom, uint8_t* streamBuffer, uint8_t len) {
-    Stream_init(&eeprom->NoiseEraseStream, streamBuffer, len);
-}
-
-
-/**
- * @brief Erase E2PROM with Random Number Generator unit of your MCU and before use this function u must do E2PROM_noiseEraseInit
- *
- * @param eeprom
- */
-void E2PROM_noiseErase(E2PROM* eeprom) {
-    E2PROM_CommandHeader    cacheHeader;
-    cacheHeader.Len        = eeprom->Config->Size;
-    cacheHeader.MemAddress = 0;
-    cacheHeader.Mode       = E2PROM_NoiseEraseMode;
-    cacheHeader.Type       = E2PROM_Variable;
-    Queue_writeItem (&eeprom->CommandQueue, &cacheHeader);
-}
-#endif
-
-
-/**
- * @brief E2PROM Handle , this function can use in your interrupt and while(1) for handle nonBlocking function
- *
- * @param eeprom Address of your E2PROM Struct
- */
-uint8_t E2PROM_handle (void) {
-    E2PROM*              pE2PROM  = lastE2PROM;
-    uint16_t             len      = 0;
-    uint8_t              overPage = 0;
-    Stream               temp;
-    E2PROM_CommandHeader header;
-    uint8_t allProcessDone = 0;
-    E2PROM_Result result;
-    
-#if E2PROM_CHECK_ENABLE
-    if (pE2PROM->Enabled) {
-#endif
-        
-            while (pE2PROM != E2PROM_NULL) {
-              if (!pE2PROM->Lock) {
-                if (Queue_available(&pE2PROM->CommandQueue) > 0 && pE2PROM->CommandHeaderInProcess.Len == 0) {
-                    Queue_readItem(&pE2PROM->CommandQueue, &pE2PROM->CommandHeaderInProcess);
-                    if (pE2PROM->CommandHeaderInProcess.Type == E2PROM_Const) {
-                        switch (pE2PROM->CommandHeaderInProcess.Mode) {
-                            case E2PROM_WriteMode:
-                                Stream_readBytes(&pE2PROM->WriteStream, (uint8_t*)&pE2PROM->ConstVal, 4);
-                                break;
-                            case E2PROM_EraseMode:
-                                pE2PROM->ConstVal = (uint8_t*)E2PROM_PAGE;
-                                break;
-                        }
-                    }
-                }
-
-                if (Queue_available(&pE2PROM->ReadQueue) > 0) {
-                    if (pE2PROM->Callbacks.onRead != NULL) {
-                        Queue_readItem(&pE2PROM->ReadQueue, &header);
-                        if (header.Len > 0 && header.MemAddress < pE2PROM->Config->Size) {
-                          Stream_lockRead(&pE2PROM->ReadStream, &temp, header.Len);
-                          pE2PROM->Callbacks.onRead(&temp, header.MemAddress, header.Len);
-                          Stream_unlockRead(&pE2PROM->ReadStream, &temp);
-                        }
-                    }
-                }
-
-                if (pE2PROM->CommandHeaderInProcess.Len > 0 && pE2PROM->CommandHeaderInProcess.MemAddress <= pE2PROM->Config->Size) {
-                    allProcessDone = 1;
-                    switch (pE2PROM->CommandHeaderInProcess.Mode) {
-                        case E2PROM_WriteMode:
-                            if (pE2PROM->NextTick < eepromDriver->getTimestamp()) {
-                                switch (pE2PROM->CommandHeaderInProcess.Type) {
-                                    case E2PROM_Const:
-                                        overPage         = (pE2PROM->CommandHeaderInProcess.Len > pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize)) ? 1 : 0;
-                                        pE2PROM->TempLen = overPage ? pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize) : pE2PROM->CommandHeaderInProcess.Len;
-                                        if (pE2PROM->InTransmit != 1) {
-                                          pE2PROM->InTransmit = 1;
-                                          result = eepromDriver->write(pE2PROM, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->ConstVal, pE2PROM->TempLen);
-                                          if (result != E2PROM_Ok) {
-                                            if (pE2PROM->Callbacks.onWriteError != NULL) {
-                                              pE2PROM->Callbacks.onWriteError (&pE2PROM->WriteStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
-                                            }
-                                          }
-                                        }
-                                        break;
-
-                                    case E2PROM_Variable:
-                                        len              = (pE2PROM->CommandHeaderInProcess.Len > Stream_directAvailable(&pE2PROM->WriteStream)) ? Stream_directAvailable(&pE2PROM->WriteStream) : pE2PROM->CommandHeaderInProcess.Len;
-                                        overPage         = (len > pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize)) ? 1 : 0;
-                                        pE2PROM->TempLen = overPage ? pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize) : len;
-                                        if (pE2PROM->InTransmit != 1) {
-                                          pE2PROM->InTransmit = 1;
-                                          result = eepromDriver->write(pE2PROM, pE2PROM->CommandHeaderInProcess.MemAddress, Stream_getReadPtr(&pE2PROM->WriteStream), pE2PROM->TempLen);
-                                          if (result != E2PROM_Ok) {
-                                            if (pE2PROM->Callbacks.onWriteError != NULL) {
-                                                pE2PROM->Callbacks.onWriteError (&pE2PROM->WriteStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
-                                            }
-                                          }
-                                        }
-                                        break;
-                                }
-                                pE2PROM->NextTick = eepromDriver->getTimestamp() + pE2PROM->Config->WriteDelayTime;
-                            }
-                            break;
-
-                        case E2PROM_ReadMode:
-                          if (pE2PROM->NextTick < eepromDriver->getTimestamp() && pE2PROM->CommandHeaderInProcess.Len > 0 && pE2PROM->InTransmit == 0) {
-                            pE2PROM->InTransmit = 1;  
-                            //eepromDriver->delayMs(10);
-                            result = eepromDriver->read (pE2PROM, pE2PROM->CommandHeaderInProcess.MemAddress, Stream_getWritePtr(&pE2PROM->ReadStream), pE2PROM->CommandHeaderInProcess.Len);
-                            if (result == E2PROM_Error) {
-                              if (pE2PROM->Callbacks.onReadError != NULL) {
-                                  pE2PROM->Callbacks.onReadError(&pE2PROM->ReadStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
-                              }
-                            }
-                            pE2PROM->NextTick = eepromDriver->getTimestamp() + pE2PROM->Config->WriteDelayTime;
-                          }
-                          break;
-
-                        case E2PROM_EraseMode:
-                            if (pE2PROM->NextTick < eepromDriver->getTimestamp() && pE2PROM->InTransmit == 0) {
-                                overPage         = (pE2PROM->CommandHeaderInProcess.Len > pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize)) ? 1 : 0;
-                                pE2PROM->TempLen = overPage ? pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize) : pE2PROM->CommandHeaderInProcess.Len;
-                                pE2PROM->InTransmit = 1;
-                                result = eepromDriver->write(pE2PROM, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->ConstVal, pE2PROM->TempLen);
-                                if (result != E2PROM_Ok && pE2PROM->Callbacks.onWriteError != NULL) {
-                                    pE2PROM->Callbacks.onWriteError (&pE2PROM->WriteStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
-                                }
-                                pE2PROM->NextTick = eepromDriver->getTimestamp() + pE2PROM->Config->WriteDelayTime;
-                            }
-                            break;
-
-                        case E2PROM_NoiseEraseMode:
-                            if (pE2PROM->NextTick < eepromDriver->getTimestamp() && pE2PROM->InTransmit == 0) {
-                                for (uint8_t i = 0; i < pE2PROM->Config->PageSize / 4; i++) {
-                                    Stream_writeUInt32(&pE2PROM->NoiseEraseStream, eepromDriver->rand());
-                                }
-                                pE2PROM->InTransmit = 1;
-                                result = eepromDriver->write(pE2PROM, pE2PROM->CommandHeaderInProcess.MemAddress, Stream_getReadPtr(&pE2PROM->NoiseEraseStream), pE2PROM->Config->PageSize);
-                                if (result != E2PROM_Ok) {
-                                    if (pE2PROM->Callbacks.onWriteError != NULL) {
-                                        pE2PROM->Callbacks.onWriteError (&pE2PROM->WriteStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
-                                    }
-                                }
-                                pE2PROM->NextTick = eepromDriver->getTimestamp() + pE2PROM->Config->WriteDelayTime;
-                            }
-                            break;
-                      }
-                   }
-                }
-                pE2PROM = pE2PROM->Previous;
-    }
-    return allProcessDone;
-#if E2PROM_CHECK_ENABLE
-    }
-#endif
-}
-
-
-
-/**
- * @brief this function must be in HAL_I2C_MemTxCpltCallback
- *
- * @param eeprom
- */
-void E2PROM_writeIRQ (E2PROM* eeprom) {
-  eeprom->InTransmit = 0;  
-  if (!eeprom->Lock) {
-        switch (eeprom->CommandHeaderInProcess.Type) {
-            case E2PROM_Variable:
-
-                switch (eeprom->CommandHeaderInProcess.Mode) {
-                    case E2PROM_WriteMode:
-                        Stream_moveReadPos(&eeprom->WriteStream, eeprom->TempLen);
-                        eeprom->CommandHeaderInProcess.MemAddress += eeprom->TempLen;
-                        eeprom->CommandHeaderInProcess.Len -= eeprom->TempLen;
-                        break;
-
-                    case E2PROM_NoiseEraseMode:
-                        Stream_moveReadPos(&eeprom->NoiseEraseStream, eeprom->Config->PageSize);
-                        eeprom->CommandHeaderInProcess.MemAddress += eeprom->Config->PageSize;
-                        eeprom->CommandHeaderInProcess.Len -= eeprom->Config->PageSize;
-                        break;
-                }
-                break;
-
-            case E2PROM_Const:
-
-                if (eeprom->CommandHeaderInProcess.Mode == E2PROM_WriteMode) {
-                    eeprom->ConstVal += eeprom->TempLen;
-                }
-                eeprom->CommandHeaderInProcess.MemAddress += eeprom->TempLen;
-                eeprom->CommandHeaderInProcess.Len -= eeprom->TempLen;
-                break;
-        }
-    } else {
-        eeprom->InBlocking = 0;
-    }
-}
-
-
-/**
- * @brief this function must be in HAL_I2C_MemRxCpltCallback
- *
- * @param eeprom
- */
-void E2PROM_readIRQ (E2PROM* eeprom) {
-  eeprom->InTransmit = 0;
-    if (!eeprom->Lock && eeprom->CommandHeaderInProcess.Len > 0) {
-        Stream_moveWritePos (&eeprom->ReadStream, eeprom->CommandHeaderInProcess.Len);
-        Queue_writeItem(&eeprom->ReadQueue, &eeprom->CommandHeaderInProcess);
-        eeprom->CommandHeaderInProcess.Len = 0;
-    }
-    else {
-        eeprom->InBlocking = 0;
-    }
-}
-
-
-
-/**
- * @brief Blocking Write Functions
- *
- * @param eeprom Address of your E2PROM struct
- * @param data Address of your Data u want to store in E2PROM Chip
- * @param addr Address of E2PROM Chip u want to store data in it
- * @param len Length of your Data
- * @return E2PROM_Result
- */
-E2PROM_Result E2PROM_writeBlocking (E2PROM* eeprom, uint16_t addr, void* data, uint16_t len) {
-    E2PROM_CommandHeader cacheHeader;
-    uint8_t              overPage = 0;
-    uint8_t              tempLen;
-    E2PROM_Result        result;
-    if ((addr <= eeprom->Config->Size) && (len <= eeprom->Config->Size) && (len > 0)) {
-        cacheHeader.MemAddress = addr;
-        cacheHeader.Len        = len;
-    } else {
-        return E2PROM_HeaderValueError;
-    }
-    eeprom->InBlocking = 1;
-    eeprom->Lock       = 1;
-    while (cacheHeader.Len > 0) {
-        overPage           = cacheHeader.Len > eeprom->Config->PageSize - (cacheHeader.MemAddress % eeprom->Config->PageSize) ? 1 : 0;
-        tempLen            = overPage ? eeprom->Config->PageSize - (cacheHeader.MemAddress % eeprom->Config->PageSize) : cacheHeader.Len;
-        eeprom->InBlocking = 1;
-        result = eepromDriver->write(eeprom, cacheHeader.MemAddress, data, tempLen);
-        if (result != E2PROM_Ok) {
-           if (eeprom->Callbacks.onWriteError != NULL) {
-              eeprom->Callbacks.onWriteError (&eeprom->WriteStream, eeprom->CommandHeaderInProcess.MemAddress, eeprom->CommandHeaderInProcess.Len);
-           }
-        }
-#if E2PROM_USE_INTERRUPT_I2C
-        while (eeprom->InBlocking) {
-        }
-#endif
-        cacheHeader.Len        -= tempLen;
-        data += tempLen;
-        cacheHeader.MemAddress += tempLen;
-        eepromDriver->delayMs (eeprom->Config->WriteDelayTime);
-    }
-    eeprom->Lock = 0;
-    return E2PROM_Ok;
-}
-
-
-
-/**
- * @brief E2PROM
- *
- * @param eeprom Address of your E2PROM struct
- * @param data Address of your Data u want to store in E2PROM Chip
- * @param addr Address of E2PROM Chip u want to store data in it
- * @param len  length of Data
- * @param type Data Type (Const or Variable)
- * @return E2PROM_Result
- */
-E2PROM_Result E2PROM_write (E2PROM* eeprom, uint16_t addr, uint8_t* data, uint16_t len, E2PROM_DataType type) {
-    E2PROM_CommandHeader cacheHeader;
-    if ((addr < eeprom->Config->Size) && (len > 0)) {
-        cacheHeader.MemAddress = addr;
-        cacheHeader.Len        = len;
-        cacheHeader.Type       = type;
-        cacheHeader.Mode       = E2PROM_WriteMode;
-        Queue_writeItem(&eeprom->CommandQueue, &cacheHeader);
-
-        if (cacheHeader.Type == E2PROM_Const) {
-            Stream_writeBytes(&eeprom->WriteStream, (uint8_t*)&data, sizeof(data));
-        } else {
-            Stream_writeBytes(&eeprom->WriteStream, data, cacheHeader.Len);
-        }
-//        eeprom->WriteReady = 1;
-        return E2PROM_Ok;
-    } else {
-        return E2PROM_HeaderValueError;
-    }
-}
-
-
-
-/**
- * @brief this function use for read from E2PROM Chip
- *
- * @param eeprom Address of E2PROM Struct
- * @param buffer buffer u want to store ReadValue in it
- * @param addr Address of E2PROM u want to Read from that Address
- * @param len Length of your DataValue
- * @return E2PROM_Result
- */
-E2PROM_Result E2PROM_read (E2PROM* eeprom, uint16_t addr, uint8_t len) {
-    E2PROM_CommandHeader cacheHeader;
-    if ((addr < eeprom->Config->Size) && (len > 0) && (len <= eeprom->Config->Size)) {
-        cacheHeader.MemAddress = addr;
-        cacheHeader.Len        = len;
-        cacheHeader.Type       = E2PROM_Variable;
-        cacheHeader.Mode       = E2PROM_ReadMode;
-        Queue_writeItem (&eeprom->CommandQueue, &cacheHeader);
-        return E2PROM_Ok;
-    } else {
-        return E2PROM_HeaderValueError;
-    }
-}
-
-
-
-/**
- * @brief
- *
- * @param eeprom   address of eeprom struct
- * @param addr     address of eeprom u want to read
- * @param val      address of buffer u want to store Data in that
- * @param len      length of Data
- * @return         E2PROM_Result
- */
-E2PROM_Result E2PROM_readBlocking (E2PROM* eeprom, uint16_t addr, uint8_t* val, uint16_t len) {
-  E2PROM_Result result;  
-  if ((addr < eeprom->Config->Size) && (len > 0) && (len < eeprom->Config->Size)) {
-        eeprom->Lock       = 1;
-        eeprom->InBlocking = 1;
-      if (eeprom->InTransmit == 0) {
-        eeprom->InTransmit = 1;  
-        result = eepromDriver->read(eeprom, addr, val, len);
-        if (result != E2PROM_Ok) {
-            if (eeprom->Callbacks.onReadError != NULL) {
-                eeprom->Callbacks.onReadError (&eeprom->ReadStream, eeprom->CommandHeaderInProcess.MemAddress, eeprom->CommandHeaderInProcess.Len); 
-            }
-        }
-      }
-#if E2PROM_USE_INTERRUPT_I2C
-        while (eeprom->InBlocking) {
-            
-        }
-#endif
-        eeprom->Lock = 0;
-        return E2PROM_Ok;
-    } else {
-        return E2PROM_HeaderValueError;
-    }
-}
-
-
-
-/**
- * @brief E2PROM NonBlocking erase  
- *
- * @param eeprom
- */
-void E2PROM_erase (E2PROM* eeprom) {
-    E2PROM_CommandHeader cacheHeader;
-    cacheHeader.Len        = eeprom->Config->Size;
-    cacheHeader.MemAddress = 0;
-    cacheHeader.Mode       = E2PROM_EraseMode;
-    cacheHeader.Type       = E2PROM_Const;
-    Queue_writeItem (&eeprom->CommandQueue, &cacheHeader);
-}
-
-
-
-
-/**
- * @brief get E2PROM Config
- *
- * @param eeprom Address of E2PROM Struct
- * @return const E2PROM_Config*
- */
-const E2PROM_Config* E2PROM_getConfig (E2PROM* eeprom) {
-    return eeprom->Config;
-}
-
-
-
-
-/**
- * @brief Set user Argument
- *
- * @param eeprom Address of E2PROM Struct
- * @param args
- */
-void StatusLed_setArgs (E2PROM* eeprom, void* args) {
-    eeprom->Args = args;
-}
-
-
-
-/**
- * @brief get User Argument
- *
- * @param eeprom Address of E2PROM Struct
- * @return void*
- */
-void* E2PROM_getArgs (E2PROM* eeprom) {
-    return eeprom->Args;
-}
-
-
-
-
-/**
- * @brief Callback Func
- *
- * @param eeprom Address of E2PROM Struct
- * @param cb
- */
-void E2PROM_onWrite (E2PROM* eeprom, E2PROM_CallbackFn cb) {
-    eeprom->Callbacks.onAfterWrite = cb;
-}
-
-
-
-/**
- * @brief Callback Func
- *
- * @param eeprom Address of E2PROM Struct
- * @param cb
- */
-void E2PROM_onRead (E2PROM* eeprom, E2PROM_CallbackFn cb) {
-    eeprom->Callbacks.onRead = cb;
-}
-
-
-/**
- * @brief Callback Func
- *
- * @param eeprom Address of E2PROM Struct
- * @param cb
- */
-void E2PROM_onReadError (E2PROM* eeprom, E2PROM_CallbackFn cb) {
-    eeprom->Callbacks.onReadError = cb;
-}
-
-
-/**
- * @brief Callback Func
- *
- * @param eeprom Address of E2PROM Struct
- * @param cb
- */
-void E2PROM_onWriteError (E2PROM* eeprom, E2PROM_CallbackFn cb) {
-    eeprom->Callbacks.onWriteError = cb;
-}
-
-
-/**
- * @brief Add another E2PROM to the Process
- *
- * @param eeprom Address of New E2PROM Struct
- * @param config Address of New E2PROM Config
- * @return E2PROM_Result
- */
-E2PROM_Result E2PROM_add (E2PROM* eeprom, const E2PROM_Config* config) {
-    // check for null
-    if (E2PROM_NULL == eeprom) {
-        return E2PROM_Null;
-    }
-    E2PROM_setConfig(eeprom, config);
-
-    // add E2PROM to linked list
-    eeprom->Previous   = __eeprom();
-    lastE2PROM         = eeprom;
-    eeprom->Configured = 1;
-
-#if E2PROM_CHECK_ENABLE
-    eeprom->Enabled    = 1;
-#endif
-
-    return E2PROM_Ok;
-}
-
-
-
-
-/**
- * @brief Remove the E2PROM
- *
- * @param remove Address of E2PROM Struct user Want to remove that
- * @return E2PROM_Result
- */
-E2PROM_Result E2PROM_remove (E2PROM* remove) {
-
-    E2PROM* pE2PROM = __eeprom();
-    if (remove == pE2PROM) {
-        lastE2PROM = remove->Previous;
-        remove->Previous   = E2PROM_NULL;
-        remove->Configured = 0;
-        remove->Enabled    = 0;
-        return E2PROM_Ok;
-    }
-    while (E2PROM_NULL != pE2PROM) {
-        if (remove == pE2PROM->Previous) {
-            pE2PROM->Previous  = remove->Previous;
-            remove->Previous   = E2PROM_NULL;
-            remove->Configured = 0;
-            remove->Enabled    = 0;
-            return E2PROM_Ok;
-        }
-        pE2PROM = pE2PROM->Previous;
-    }
-    return E2PROM_Error;
-}
-
-
-#if E2PROM_CHECK_ENABLE
-/**
- * @brief set enable/disable eeprom
- *
- * @param eeprom Address of E2PROM Struct
- * @param enabled
- */
-void E2PROM_setEnabled (E2PROM* eeprom, uint8_t enabled) {
-    eeprom->Enabled = enabled;
-}
-
-/**
- * @brief return 1 if Enable and 0 if Disable
- *
- * @param eeprom Address of E2PROM Struct
- * @return uint8_t
- */
-uint8_t E2PROM_isEnabled (E2PROM* eeprom) {
-    return eeprom->Enabled;
-}
-
-#endif
-
-
-
-/**
- * @brief this Function use for compare 2 Array user can test the write and Read,  
- * 
- * @param arr1 Address of Array1
- * @param arr2 Address of Array2
- * @param len  Length user want to compare between the Array1 & Array2 
- * @return int8_t / return 0 if the two Array is Equal
- */
-int8_t E2PROM_assertMemory (uint8_t* arr1, uint8_t* arr2, uint16_t len) {
-  return memcmp (arr1, arr2, len);
-}
-
-/************************************************ Write/Read NonBlocking *****************************************************/
-E2PROM_Result E2PROM_writeUInt8 (E2PROM* eeprom, uint8_t val, uint16_t addr) {
-    return E2PROM_write (eeprom, addr, (uint8_t*)&val, sizeof(val), E2PROM_Variable);
-}
-void E2PROM_readUInt8 (E2PROM* eeprom, uint16_t addr) {
-    E2PROM_read (eeprom, addr, sizeof(uint8_t));
-}
-
-
-E2PROM_Result E2PROM_writeUInt16 (E2PROM* eeprom, uint16_t val, uint16_t addr) {
-    return E2PROM_write (eeprom, addr, (uint8_t*)&val, sizeof(val), E2PROM_Variable);
-}
-void E2PROM_readUInt16 (E2PROM* eeprom, uint16_t addr) {
-    E2PROM_read (eeprom, addr, sizeof(uint16_t));
-}
-
-
-E2PROM_Result E2PROM_writeUInt32 (E2PROM* eeprom, uint32_t val, uint16_t addr) {
-    return E2PROM_write (eeprom, addr, (uint8_t*)&val, sizeof(val), E2PROM_Variable);
-}
-void E2PROM_readUInt32 (E2PROM* eeprom, uint16_t addr) {
-    E2PROM_read (eeprom, addr, sizeof(uint32_t));
-}
-
-
-
-E2PROM_Result E2PROM_writeUInt64 (E2PROM* eeprom, uint64_t val, uint16_t addr) {
-    return E2PROM_write (eeprom, addr, (uint8_t*)&val, sizeof(val), E2PROM_Variable);
-}
-
-void E2PROM_readUInt64 (E2PROM* eeprom, uint16_t addr) {
-    E2PROM_read (eeprom, addr, sizeof(uint64_t));
-}
-
-/************************************************** Write/Read Blocking *********************************************************/
-
-E2PROM_Result E2PROM_writeUInt8Blocking (E2PROM* eeprom, uint8_t val, uint16_t addr) {
-    return E2PROM_writeBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
-}
-uint8_t E2PROM_readUInt8Blocking (E2PROM* eeprom, uint16_t addr) {
-    uint8_t val = 0;
-    E2PROM_readBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
-    return val;
-}
-
-
-E2PROM_Result E2PROM_writeUInt16Blocking (E2PROM* eeprom, uint16_t val, uint16_t addr) {
-    return E2PROM_writeBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
-}
-uint16_t E2PROM_readUInt16Blocking (E2PROM* eeprom, uint16_t addr) {
-    uint16_t val = 0;
-    E2PROM_readBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
-    return val;
-}
-
-
-E2PROM_Result E2PROM_writeUInt32Blocking (E2PROM* eeprom, uint32_t val, uint16_t addr) {
-    return E2PROM_writeBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
-}
-
-uint32_t E2PROM_readUInt32Blocking (E2PROM* eeprom, uint16_t addr) {
-    uint32_t val = 0;
-    E2PROM_readBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
-    return val;
-}
-
-
-E2PROM_Result E2PROM_writeUInt64Blocking (E2PROM* eeprom, uint64_t val, uint16_t addr) {
-    return E2PROM_writeBlocking(eeprom, addr, (uint8_t*)&val, sizeof(val));
-}
-uint64_t E2PROM_readUInt64Blocking (E2PROM* eeprom, uint16_t addr) {
-    uint64_t val = 0;
-    E2PROM_readBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
-    return val;
-}
-/***********************************************************************************************************/
-
-
-/**
- * @brief if the handle process not complete with this Function u can wait As much as this timeout 
- * 
- * @param timeout 
- * @return E2PROM_Result 
- */
-E2PROM_Result E2PROM_waitForFinishProcess (E2PROM_Timestamp timeout) {    
-     E2PROM_Timestamp time = eepromDriver->getTimestamp() + timeout;
-    while ( E2PROM_handle() && eepromDriver->getTimestamp() < time) {
-    }
-}
-
+#include "E2PROM.h"
+#if E2PROM_WEAR_TRACKING
+#include "E2PROMCrc.h"
+#endif
+
+#include <string.h>
+
+const E2PROM_Driver* eepromDriver;
+static E2PROM* lastE2PROM = E2PROM_NULL;
+#if E2PROM_USE_POOL
+static uint8_t*         poolBuffer = (uint8_t*)0;
+static uint32_t         poolFree   = 0; /**< one bit for each free block */
+static volatile uint8_t poolSubmit = 0; /**< a submit function is borrowing, handle must not give back blocks */
+static uint8_t          poolHeld[E2PROM_PoolBuffers]; /**< blocks device held before current submit */
+#endif
+
+
+
+#define __eeprom()      lastE2PROM
+#define __next(E2PROM)  E2PROM = (E2PROM)->Previous
+// timestamps wrap, compare their distance
+#define __deadlineBefore(A, B)  ((int32_t)((A) - (B)) < 0)
+
+
+
+/**
+ * @brief this Array use for E2PROM Erase with 0xFF and u can change Value in the Configure  
+ */
+static const uint8_t E2PROM_PAGE[] = {
+    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
+    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
+    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
+    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
+    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
+    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
+    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
+    E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE, E2PROM_DEFAULT_VALUE,
+};
+
+
+
+
+
+#if E2PROM_WEAR_TRACKING
+/**
+ * @brief count one program cycle for every page touched by a write
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param addr   Address of write
+ * @param len    Length of write
+ */
+static void E2PROM_wearTrack(E2PROM* eeprom, uint16_t addr, uint16_t len) {
+    uint16_t page;
+    uint16_t last;
+    if (eeprom->WearMap == NULL || len == 0) {
+        return;
+    }
+    page = addr / eeprom->Config->PageSize;
+    last = (addr + len - 1) / eeprom->Config->PageSize;
+    while (page <= last && page < E2PROM_wearPages(eeprom)) {
+        eeprom->WearMap[page++]++;
+    }
+    // writes of WearMap itself must not trigger another persist
+    if (addr < eeprom->WearAddress || addr >= eeprom->WearAddress + E2PROM_wearRegionSize(eeprom)) {
+        eeprom->WearPending++;
+    }
+    eeprom->WearSession++;
+}
+#endif
+
+
+
+#if E2PROM_TRACE
+static E2PROM_TraceRecord*    traceBuffer = (E2PROM_TraceRecord*)0;
+static E2PROM_getTimestampFn  traceGetTimestamp;
+static uint16_t               traceSize;
+static uint16_t               traceHead;
+static uint16_t               traceCount;
+static uint32_t               traceTaken; /**< records taken, a Result is set only while its slot is not taken again */
+static uint8_t                traceNextId;
+
+/**
+ * @brief put a record in trace ring buffer, oldest record is overwritten when it is full
+ *        record is taken before the driver call, so a completion IRQ inside the call is recorded after it
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param event  E2PROM_TraceEvent
+ * @param mode   E2PROM_Mode
+ * @param addr   Address of E2PROM Chip
+ * @param len    Length of transfer
+ * @param ticket number of record, for E2PROM_traceResult, can be NULL
+ * @return E2PROM_TraceRecord* NULL if trace is stopped
+ */
+static E2PROM_TraceRecord* E2PROM_trace(E2PROM* eeprom, uint8_t event, uint8_t mode, uint16_t addr, uint16_t len, uint32_t* ticket) {
+    E2PROM_TraceRecord* record = (E2PROM_TraceRecord*)0;
+    E2PROM_TRACE_ENTER_CRITICAL();
+    if (traceBuffer != (E2PROM_TraceRecord*)0) {
+        record    = &traceBuffer[traceHead];
+        traceHead = (traceHead + 1) % traceSize;
+        if (traceCount < traceSize) {
+            traceCount++;
+        }
+        traceTaken++;
+        if (ticket != NULL) {
+            *ticket = traceTaken;
+        }
+        record->Timestamp = traceGetTimestamp();
+        record->Address   = addr;
+        record->Len       = len;
+        record->Device    = eeprom->TraceId;
+        record->Mode      = mode;
+        record->Event     = eeprom->Lock ? (event | E2PROM_TraceBlocking) : event;
+        record->Result    = E2PROM_Ok;
+    }
+    E2PROM_TRACE_EXIT_CRITICAL();
+    return record;
+}
+
+
+
+/**
+ * @brief set Result of a record after the driver call, skipped if ring wrapped in the call and slot is taken again
+ *
+ * @param record record of E2PROM_trace
+ * @param ticket ticket of E2PROM_trace
+ * @param result E2PROM_Result of driver
+ */
+static void E2PROM_traceResult(E2PROM_TraceRecord* record, uint32_t ticket, E2PROM_Result result) {
+    E2PROM_TRACE_ENTER_CRITICAL();
+    if (traceBuffer != (E2PROM_TraceRecord*)0 && traceTaken - ticket < traceSize) {
+        record->Result = result;
+    }
+    E2PROM_TRACE_EXIT_CRITICAL();
+}
+#endif
+
+
+
+/**
+ * @brief every page program of the engine pass from here to the driver
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param mode   E2PROM_Mode of the program
+ * @param addr   Address of E2PROM Chip
+ * @param data   Address of Data
+ * @param len    Length of Data, must not cross a page
+ * @return E2PROM_Result
+ */
+static E2PROM_Result E2PROM_pageWrite(E2PROM* eeprom, uint8_t mode, uint16_t addr, uint8_t* data, uint16_t len) {
+    E2PROM_Result result;
+#if E2PROM_TRACE
+    E2PROM_TraceRecord* record;
+    uint32_t            ticket;
+    record = E2PROM_trace(eeprom, E2PROM_TraceWrite, mode, addr, len, &ticket);
+#else
+    (void)mode;
+#endif
+    result = eepromDriver->write(eeprom, addr, data, len);
+#if E2PROM_TRACE
+    if (record != (E2PROM_TraceRecord*)0) {
+        E2PROM_traceResult(record, ticket, result);
+    }
+#endif
+#if E2PROM_WEAR_TRACKING
+    if (result == E2PROM_Ok) {
+        E2PROM_wearTrack(eeprom, addr, len);
+    }
+#endif
+    return result;
+}
+
+
+
+/**
+ * @brief every read of the engine pass from here to the driver
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param addr   Address of E2PROM Chip
+ * @param buffer Address of buffer
+ * @param len    Length of Data
+ * @return E2PROM_Result
+ */
+static E2PROM_Result E2PROM_busRead(E2PROM* eeprom, uint16_t addr, uint8_t* buffer, uint16_t len) {
+    E2PROM_Result result;
+#if E2PROM_TRACE
+    E2PROM_TraceRecord* record;
+    uint32_t            ticket;
+    record = E2PROM_trace(eeprom, E2PROM_TraceRead, E2PROM_ReadMode, addr, len, &ticket);
+#endif
+    result = eepromDriver->read(eeprom, addr, buffer, len);
+#if E2PROM_TRACE
+    if (record != (E2PROM_TraceRecord*)0) {
+        E2PROM_traceResult(record, ticket, result);
+    }
+#endif
+    return result;
+}
+
+
+
+/**
+ * @brief initial the E2PROM Driver
+ * @param driver
+ */
+void E2PROM_driverInit(const E2PROM_Driver* driver) {
+    eepromDriver = driver;
+}
+
+
+
+/**
+ * @brief  DeInitial the E2PROM Driver
+ *
+ * @param driver
+ */
+void E2PROM_deInit(void) {
+    eepromDriver = NULL_DRIVER;
+}
+
+
+
+/**
+ * @brief Set E2PROM Config
+ *
+ * @param eeprom
+ * @param config
+ */
+void E2PROM_setConfig(E2PROM* eeprom, const E2PROM_Config* config) {
+    eeprom->Config = config;
+}
+
+
+
+#if E2PROM_USE_INTERRUPT_I2C
+/**
+ * @brief wait for IRQ of transfer of blocking functions, sleep in driver wait if it has
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return E2PROM_Result E2PROM_TimeOutError if wait of driver is timed out
+ */
+static E2PROM_Result E2PROM_waitBlocking(E2PROM* eeprom) {
+    E2PROM_Result result = E2PROM_Ok;
+    while (eeprom->InBlocking && result == E2PROM_Ok) {
+        if (eepromDriver->wait != NULL) {
+            result = eepromDriver->wait(eeprom, E2PROM_BLOCKING_TIMEOUT);
+        }
+    }
+    if (result != E2PROM_Ok) {
+        // IRQ is lost, don't stay in blocking mode
+        eeprom->InBlocking = 0;
+        eeprom->InTransmit = 0;
+    }
+    return result;
+}
+#endif
+
+
+
+/**
+ * @brief Erase the E2PROM
+ *
+ * @param eeprom
+ * @return E2PROM_Result stop at first page that is not erased
+ */
+E2PROM_Result E2PROM_eraseBlocking(E2PROM* eeprom) {
+    E2PROM_Result result;
+    eeprom->Lock  = 1;
+    uint16_t cnt  = eeprom->Config->Size;
+    uint16_t addr = 0;
+    while (cnt > 0) {
+        eeprom->InBlocking = 1;
+        result = E2PROM_pageWrite(eeprom, E2PROM_EraseMode, addr, (uint8_t*)E2PROM_PAGE, eeprom->Config->PageSize);
+        if (result != E2PROM_Ok) {
+            eeprom->InBlocking = 0;
+            eeprom->Lock       = 0;
+            return result;
+        }
+#if E2PROM_USE_INTERRUPT_I2C
+        result = E2PROM_waitBlocking(eeprom);
+        if (result != E2PROM_Ok) {
+            eeprom->Lock = 0;
+            return result;
+        }
+#endif
+        addr += eeprom->Config->PageSize;
+        cnt  -= eeprom->Config->PageSize;
+        eepromDriver->delayMs(eeprom->Config->WriteDelayTime);
+    }
+    eeprom->Lock = 0;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief Erase the E2PROM with Noise Value
+ *
+ * @param eeprom  Address of your E2PROM
+ * @return E2PROM_Result stop at first part that is not written
+ */
+E2PROM_Result E2PROM_noiseEraseBlocking(E2PROM* eeprom) {
+    E2PROM_Result result;
+    eeprom->Lock  = 1;
+    uint16_t cnt  = eeprom->Config->Size / 4;
+    uint16_t addr = 0;
+    uint32_t temp;
+    while (cnt > 0) {
+        temp = eepromDriver->rand();
+        eeprom->InBlocking = 1;
+        result = E2PROM_pageWrite(eeprom, E2PROM_NoiseEraseMode, addr, (uint8_t*)&temp, 4);
+        if (result != E2PROM_Ok) {
+            eeprom->InBlocking = 0;
+            eeprom->Lock       = 0;
+            return result;
+        }
+#if E2PROM_USE_INTERRUPT_I2C
+        result = E2PROM_waitBlocking(eeprom);
+        if (result != E2PROM_Ok) {
+            eeprom->Lock = 0;
+            return result;
+        }
+#endif
+        addr += 4;
+        cnt--;
+        eepromDriver->delayMs(eeprom->Config->WriteDelayTime);
+    }
+    eeprom->Lock = 0;
+    return E2PROM_Ok;
+}
+
+
+/**
+ * @brief initial E2PROM , and u must init your E2PROM before use it
+ *
+ * @param eeprom            Address of your E2PROM
+ * @param commandQBuffer    Address of Buffer u need for initial the CommandQueue
+ * @param commandQLen       Length of Buffer, u must Enter sizeof(commandQBuffer)
+ * @param qReadBuffer       Address of Buffer u need for initial the ReadQueue
+ * @param qReadLen          Length of Buffer, u must Enter sizeof(qReadBuffer)
+ * @param streamWriteBuffer Address of Buffer u need for initial the WriteStream
+ * @param streamWriteLen    Length of Buffer, u must Enter sizeof(streamWriteBuffer)
+ * @param streamReadBuffer  Address of Buffer u need for initial the ReadStream
+ * @param streamReadLen     Length of Buffer, u must Enter sizeof(streamReadBuffer)
+ */
+void E2PROM_init (E2PROM* eeprom, uint8_t* commandQBuffer, uint16_t commandQLen, uint8_t* qReadBuffer, uint16_t qReadLen, uint8_t* streamWriteBuffer, uint16_t streamWriteLen, uint8_t* streamReadBuffer, uint16_t streamReadLen) {
+    eeprom->NextTick                          = 0;
+    eeprom->Configured                        = 0;
+    eeprom->Lock                              = 0;
+    eeprom->CommandHeaderInProcess.Len        = 0;
+    eeprom->CommandHeaderInProcess.MemAddress = 0;
+    eeprom->CommandHeaderInProcess.Mode       = 0;
+    eeprom->CommandHeaderInProcess.Type       = 0;
+    eeprom->InTransmit                        = 0;
+#if E2PROM_WEAR_TRACKING
+    eeprom->WearMap                           = NULL;
+#endif
+#if E2PROM_READ_BATCH
+    eeprom->onReadBatch                       = NULL;
+#endif
+#if E2PROM_USE_DEADLINE
+    eeprom->CommandHeaderInProcess.HasDeadline = 0;
+    eeprom->Suspended.Len                     = 0;
+    eeprom->onDeadline                        = NULL;
+    eeprom->UrgentMissed                      = 0;
+    eeprom->InUrgent                          = 0;
+    for (uint8_t i = 0; i < E2PROM_DEADLINE_SLOTS; i++) {
+        eeprom->Urgent[i].Len = 0;
+    }
+#endif
+#if E2PROM_USE_STAGING
+    eeprom->Staged                            = 0;
+#endif
+#if E2PROM_WRITE_VERIFY
+    eeprom->VerifyPending                     = 0;
+    eeprom->VerifyRetries                     = 0;
+    eeprom->InVerify                          = 0;
+    eeprom->VerifyFailed                      = 0;
+#endif
+#if E2PROM_USE_POOL
+    eeprom->PoolQuota                         = 0;
+    memset(eeprom->PoolCount, 0, sizeof(eeprom->PoolCount));
+#endif
+    Queue_init(&eeprom->CommandQueue, commandQBuffer, commandQLen, sizeof(E2PROM_CommandHeader));
+    Queue_init(&eeprom->ReadQueue, qReadBuffer, qReadLen, sizeof(E2PROM_CommandHeader));
+    Stream_init(&eeprom->WriteStream, streamWriteBuffer, streamWriteLen);
+    Stream_init(&eeprom->ReadStream, streamReadBuffer, streamReadLen);
+  
+}
+
+#if E2PROM_USE_POOL
+/**
+ * @brief initial shared pool, buffer split to blocks of E2PROM_POOL_BLOCK_SIZE
+ *
+ * @param buffer Address of pool memory
+ * @param len    Length of pool memory, sizeof(buffer)
+ */
+void E2PROM_poolInit(uint8_t* buffer, uint16_t len) {
+    uint16_t blocks = len / E2PROM_POOL_BLOCK_SIZE;
+    if (blocks > E2PROM_POOL_MAX_BLOCKS) {
+        blocks = E2PROM_POOL_MAX_BLOCKS;
+    }
+    poolBuffer = buffer;
+    poolFree   = blocks >= 32 ? 0xFFFFFFFFUL : ((1UL << blocks) - 1);
+}
+
+
+
+/**
+ * @brief initial E2PROM without own buffers, queues and streams are borrowed from pool when a command is submitted
+ *        and given back in E2PROM_handle when they are empty
+ *        NoiseEraseStream is not borrowed, it is used during whole chip noise erase, give its buffer with E2PROM_noiseEraseInit
+ *
+ * @param eeprom Address of your E2PROM
+ * @param quota  max blocks this device can hold at same time
+ */
+void E2PROM_initPooled(E2PROM* eeprom, uint8_t quota) {
+    E2PROM_init(eeprom, NULL, 0, NULL, 0, NULL, 0, NULL, 0);
+    eeprom->PoolQuota = quota;
+}
+
+
+
+/**
+ * @brief number of free blocks in pool
+ *
+ * @return uint8_t
+ */
+uint8_t E2PROM_poolFreeBlocks(void) {
+    uint32_t free  = poolFree;
+    uint8_t  count = 0;
+    while (free) {
+        free &= free - 1;
+        count++;
+    }
+    return count;
+}
+
+
+
+/**
+ * @brief number of blocks device hold now
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint8_t
+ */
+uint8_t E2PROM_poolHeldBlocks(E2PROM* eeprom) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < E2PROM_PoolBuffers; i++) {
+        count += eeprom->PoolCount[i];
+    }
+    return count;
+}
+
+
+
+/**
+ * @brief initial a buffer of device on memory
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param buffer E2PROM_PoolBuffer
+ * @param data   Address of memory, NULL for a buffer that is not borrowed
+ * @param len    Length of memory
+ */
+static void E2PROM_poolSetBuffer(E2PROM* eeprom, uint8_t buffer, uint8_t* data, uint16_t len) {
+    switch (buffer) {
+        case E2PROM_PoolCommandQueue:
+            Queue_init(&eeprom->CommandQueue, data, len, sizeof(E2PROM_CommandHeader));
+            break;
+        case E2PROM_PoolReadQueue:
+            Queue_init(&eeprom->ReadQueue, data, len, sizeof(E2PROM_CommandHeader));
+            break;
+        case E2PROM_PoolWriteStream:
+            Stream_init(&eeprom->WriteStream, data, len);
+            break;
+        case E2PROM_PoolReadStream:
+            Stream_init(&eeprom->ReadStream, data, len);
+            break;
+    }
+}
+
+
+
+/**
+ * @brief give blocks of a buffer back to pool
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param buffer E2PROM_PoolBuffer
+ */
+static void E2PROM_poolRelease(E2PROM* eeprom, uint8_t buffer) {
+    uint8_t count = eeprom->PoolCount[buffer];
+    if (count > 0) {
+        poolFree                 |= (count >= 32 ? 0xFFFFFFFFUL : ((1UL << count) - 1)) << eeprom->PoolFirst[buffer];
+        eeprom->PoolCount[buffer] = 0;
+        E2PROM_poolSetBuffer(eeprom, buffer, NULL, 0);
+    }
+}
+
+
+
+/**
+ * @brief device has no command queued or in process, so its streams are not used by a transfer
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint8_t
+ */
+static uint8_t E2PROM_poolIdle(E2PROM* eeprom) {
+    if (eeprom->CommandHeaderInProcess.Len > 0 || eeprom->InTransmit || Queue_available(&eeprom->CommandQueue) > 0) {
+        return 0;
+    }
+#if E2PROM_USE_DEADLINE
+    // requests with deadline use the buffers too
+    if (eeprom->Suspended.Len > 0) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < E2PROM_DEADLINE_SLOTS; i++) {
+        if (eeprom->Urgent[i].Len > 0) {
+            return 0;
+        }
+    }
+#endif
+    return 1;
+}
+
+
+
+/**
+ * @brief take count free blocks of pool for a buffer
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param buffer E2PROM_PoolBuffer
+ * @param count  number of blocks
+ * @return E2PROM_Result E2PROM_Busy if pool or quota of device is exhausted
+ */
+static E2PROM_Result E2PROM_poolTake(E2PROM* eeprom, uint8_t buffer, uint8_t count) {
+    uint32_t mask;
+    if (count > E2PROM_POOL_MAX_BLOCKS || E2PROM_poolHeldBlocks(eeprom) + count > eeprom->PoolQuota) {
+        return E2PROM_Busy;
+    }
+    mask = count >= 32 ? 0xFFFFFFFFUL : ((1UL << count) - 1);
+    for (uint8_t first = 0; first + count <= E2PROM_POOL_MAX_BLOCKS; first++) {
+        if ((poolFree & (mask << first)) == (mask << first)) {
+            poolFree                 &= ~(mask << first);
+            eeprom->PoolFirst[buffer] = first;
+            eeprom->PoolCount[buffer] = count;
+            E2PROM_poolSetBuffer(eeprom, buffer, &poolBuffer[first * E2PROM_POOL_BLOCK_SIZE], count * E2PROM_POOL_BLOCK_SIZE);
+            return E2PROM_Ok;
+        }
+    }
+    return E2PROM_Busy;
+}
+
+
+
+/**
+ * @brief borrow a buffer for len bytes, if device hold it already check its space,
+ *        a too small stream is changed only when device is idle, a transfer may still use an empty one
+ *        WriteStream is borrowed with E2PROM_POOL_WRITE_BLOCKS at least if quota and pool have them
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param buffer E2PROM_PoolBuffer
+ * @param len    bytes must fit in buffer
+ * @return E2PROM_Result E2PROM_Busy if pool or quota of device is exhausted
+ */
+static E2PROM_Result E2PROM_poolBorrow(E2PROM* eeprom, uint8_t buffer, uint16_t len) {
+    uint8_t count = (len + E2PROM_POOL_BLOCK_SIZE - 1) / E2PROM_POOL_BLOCK_SIZE;
+    uint8_t least;
+    if (eeprom->PoolCount[buffer] > 0) {
+        switch (buffer) {
+            case E2PROM_PoolCommandQueue:
+                return Queue_space(&eeprom->CommandQueue) > 0 ? E2PROM_Ok : E2PROM_Busy;
+            case E2PROM_PoolReadQueue:
+                return Queue_space(&eeprom->ReadQueue) > 0 ? E2PROM_Ok : E2PROM_Busy;
+            case E2PROM_PoolWriteStream:
+                if (Stream_space(&eeprom->WriteStream) >= len) {
+                    return E2PROM_Ok;
+                }
+                if (Stream_available(&eeprom->WriteStream) > 0 || !E2PROM_poolIdle(eeprom)) {
+                    return E2PROM_Busy;
+                }
+                break;
+            case E2PROM_PoolReadStream:
+                if (Stream_space(&eeprom->ReadStream) >= len) {
+                    return E2PROM_Ok;
+                }
+                if (Stream_available(&eeprom->ReadStream) > 0 || Queue_available(&eeprom->ReadQueue) > 0 || !E2PROM_poolIdle(eeprom)) {
+                    return E2PROM_Busy;
+                }
+                break;
+        }
+        // empty stream is too small, borrow a bigger one
+        E2PROM_poolRelease(eeprom, buffer);
+    }
+    if (count == 0) {
+        count = 1;
+    }
+    if (buffer == E2PROM_PoolWriteStream && E2PROM_poolHeldBlocks(eeprom) < eeprom->PoolQuota) {
+        least = eeprom->PoolQuota - E2PROM_poolHeldBlocks(eeprom);
+        if (least > E2PROM_POOL_WRITE_BLOCKS) {
+            least = E2PROM_POOL_WRITE_BLOCKS;
+        }
+        if (least > count && E2PROM_poolTake(eeprom, buffer, least) == E2PROM_Ok) {
+            return E2PROM_Ok;
+        }
+    }
+    return E2PROM_poolTake(eeprom, buffer, count);
+}
+
+
+
+/**
+ * @brief give back buffers borrowed by last E2PROM_poolSubmit, its command is not queued
+ *
+ * @param eeprom Address of E2PROM Struct
+ */
+static void E2PROM_poolCancel(E2PROM* eeprom) {
+    if (eeprom->PoolQuota > 0) {
+        for (uint8_t i = 0; i < E2PROM_PoolBuffers; i++) {
+            if (poolHeld[i] == 0) {
+                E2PROM_poolRelease(eeprom, i);
+            }
+        }
+    }
+    poolSubmit = 0;
+}
+
+
+
+/**
+ * @brief borrow buffers a command need, caller must clear poolSubmit after the command is queued
+ *        or call E2PROM_poolCancel if command is refused
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param mode   E2PROM_Mode of command
+ * @param len    bytes of command in stream
+ * @return E2PROM_Result
+ */
+static E2PROM_Result E2PROM_poolSubmit(E2PROM* eeprom, uint8_t mode, uint16_t len) {
+    E2PROM_Result result;
+    poolSubmit = 1;
+    if (eeprom->PoolQuota == 0) {
+        return E2PROM_Ok;
+    }
+    memcpy(poolHeld, eeprom->PoolCount, sizeof(poolHeld));
+    result = E2PROM_poolBorrow(eeprom, E2PROM_PoolCommandQueue, sizeof(E2PROM_CommandHeader));
+    if (result == E2PROM_Ok) {
+        switch (mode) {
+            case E2PROM_WriteMode:
+                result = E2PROM_poolBorrow(eeprom, E2PROM_PoolWriteStream, len);
+                break;
+            case E2PROM_ReadMode:
+                result = E2PROM_poolBorrow(eeprom, E2PROM_PoolReadQueue, sizeof(E2PROM_CommandHeader));
+                if (result == E2PROM_Ok) {
+                    result = E2PROM_poolBorrow(eeprom, E2PROM_PoolReadStream, len);
+                }
+                break;
+        }
+    }
+    if (result != E2PROM_Ok) {
+        E2PROM_poolCancel(eeprom);
+    }
+    return result;
+}
+
+
+
+/**
+ * @brief give back empty buffers of an idle device
+ *
+ * @param eeprom Address of E2PROM Struct
+ */
+static void E2PROM_poolGiveBack(E2PROM* eeprom) {
+    if (eeprom->PoolQuota == 0 || poolSubmit || !E2PROM_poolIdle(eeprom)) {
+        return;
+    }
+    E2PROM_poolRelease(eeprom, E2PROM_PoolCommandQueue);
+    if (Stream_available(&eeprom->WriteStream) == 0) {
+        E2PROM_poolRelease(eeprom, E2PROM_PoolWriteStream);
+    }
+    if (Queue_available(&eeprom->ReadQueue) == 0 && Stream_available(&eeprom->ReadStream) == 0) {
+        E2PROM_poolRelease(eeprom, E2PROM_PoolReadQueue);
+        E2PROM_poolRelease(eeprom, E2PROM_PoolReadStream);
+    }
+}
+#endif
+
+
+
+#if E2PROM_NOISE_ERASE_NON_BLOCKING
+/**
+ * @brief if u want to use NonBlocking NoiseErase u must use this function and after this u can use E2PROM_noiseErase
+ *
+ * @param eeprom Address of your E2PROM
+ * @param streamBuffer address of buffer for init NoiseEraseStream
+ * @param len Length of Buffer, sizeof(streamBuffer)
+ */
+void E2PROM_noiseEraseInit(E2PROM* eeprom, uint8_t* streamBuffer, uint8_t len) {
+    Stream_init(&eeprom->NoiseEraseStream, streamBuffer, len);
+}
+
+
+/**
+ * @brief Erase E2PROM with Random Number Generator unit of your MCU and before use this function u must do E2PROM_noiseEraseInit
+ *
+ * @param eeprom
+ * @return E2PROM_Result E2PROM_Busy if CommandQueue is full
+ */
+E2PROM_Result E2PROM_noiseErase(E2PROM* eeprom) {
+    E2PROM_CommandHeader    cacheHeader;
+#if E2PROM_USE_POOL
+    if (E2PROM_poolSubmit(eeprom, E2PROM_NoiseEraseMode, 0) != E2PROM_Ok) {
+        return E2PROM_Busy;
+    }
+#endif
+    if (Queue_space(&eeprom->CommandQueue) == 0) {
+#if E2PROM_USE_POOL
+        E2PROM_poolCancel(eeprom);
+#endif
+        return E2PROM_Busy;
+    }
+    cacheHeader.Len        = eeprom->Config->Size;
+    cacheHeader.MemAddress = 0;
+    cacheHeader.Mode       = E2PROM_NoiseEraseMode;
+    cacheHeader.Type       = E2PROM_Variable;
+#if E2PROM_USE_DEADLINE
+    cacheHeader.HasDeadline = 0;
+#endif
+    Queue_writeItem (&eeprom->CommandQueue, &cacheHeader);
+#if E2PROM_USE_POOL
+    poolSubmit = 0;
+#endif
+    return E2PROM_Ok;
+}
+#endif
+
+
+/**
+ * @brief programmed page is finished, go to next page of command in process
+ *
+ * @param eeprom Address of E2PROM Struct
+ */
+static void E2PROM_pageDone(E2PROM* eeprom) {
+    uint8_t failed = 0;
+    switch (eeprom->CommandHeaderInProcess.Type) {
+        case E2PROM_Variable:
+
+            switch (eeprom->CommandHeaderInProcess.Mode) {
+                case E2PROM_WriteMode:
+#if E2PROM_USE_STAGING
+                    // page is taken from WriteStream when it is staged
+                    eeprom->Staged = 0;
+#else
+                    Stream_moveReadPos(&eeprom->WriteStream, eeprom->TempLen);
+#endif
+                    eeprom->CommandHeaderInProcess.MemAddress += eeprom->TempLen;
+                    eeprom->CommandHeaderInProcess.Len -= eeprom->TempLen;
+                    break;
+
+                case E2PROM_NoiseEraseMode:
+                    Stream_moveReadPos(&eeprom->NoiseEraseStream, eeprom->Config->PageSize);
+                    eeprom->CommandHeaderInProcess.MemAddress += eeprom->Config->PageSize;
+                    eeprom->CommandHeaderInProcess.Len -= eeprom->Config->PageSize;
+                    break;
+            }
+            break;
+
+        case E2PROM_Const:
+
+            if (eeprom->CommandHeaderInProcess.Mode == E2PROM_WriteMode) {
+                eeprom->ConstVal += eeprom->TempLen;
+            }
+            eeprom->CommandHeaderInProcess.MemAddress += eeprom->TempLen;
+            eeprom->CommandHeaderInProcess.Len -= eeprom->TempLen;
+            break;
+    }
+    // last page of write is done, a write that failed verify is finished by its onWriteError
+    if (eeprom->CommandHeaderInProcess.Mode == E2PROM_WriteMode && eeprom->CommandHeaderInProcess.Len == 0) {
+#if E2PROM_WRITE_VERIFY
+        failed               = eeprom->VerifyFailed;
+        eeprom->VerifyFailed = 0;
+#endif
+        if (!failed && eeprom->Callbacks.onAfterWrite != NULL) {
+            eeprom->Callbacks.onAfterWrite(&eeprom->WriteStream, eeprom->CommandHeaderInProcess.MemAddress - eeprom->TempLen, eeprom->TempLen);
+        }
+    }
+}
+
+
+
+#if E2PROM_WRITE_VERIFY
+/**
+ * @brief length of next part of programmed page to read back
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint8_t
+ */
+static uint8_t E2PROM_verifyLen(E2PROM* eeprom) {
+    uint8_t len = eeprom->TempLen - eeprom->VerifyOffset;
+    return len > E2PROM_VERIFY_BUFFER_SIZE ? E2PROM_VERIFY_BUFFER_SIZE : len;
+}
+
+
+
+/**
+ * @brief programmed page is not same as source, program it again or report it and go on
+ *
+ * @param eeprom Address of E2PROM Struct
+ */
+static void E2PROM_verifyFailed(E2PROM* eeprom) {
+    eeprom->VerifyPending = 0;
+    if (eeprom->VerifyRetries < E2PROM_VERIFY_RETRIES) {
+        // page is not moved, handle program it again
+        eeprom->VerifyRetries++;
+        return;
+    }
+    eeprom->VerifyRetries = 0;
+    // first bad page is reported, rest of write is still programmed but gets no other callback
+    if (!eeprom->VerifyFailed && eeprom->Callbacks.onWriteError != NULL) {
+        eeprom->Callbacks.onWriteError(&eeprom->WriteStream, eeprom->CommandHeaderInProcess.MemAddress, eeprom->TempLen);
+    }
+    eeprom->VerifyFailed = 1;
+    E2PROM_pageDone(eeprom);
+}
+
+
+
+/**
+ * @brief read back next part of programmed page, after write cycle of page
+ *        NextTick is not moved, so next page is programmed as soon as verify is done
+ *
+ * @param eeprom Address of E2PROM Struct
+ */
+static void E2PROM_verifyRead(E2PROM* eeprom) {
+    E2PROM_Result result;
+    if (eeprom->InTransmit || eeprom->NextTick >= eepromDriver->getTimestamp()) {
+        return;
+    }
+    eeprom->InTransmit = 1;
+    eeprom->InVerify   = 1;
+    result = E2PROM_busRead(eeprom, eeprom->CommandHeaderInProcess.MemAddress + eeprom->VerifyOffset, eeprom->VerifyBuffer, E2PROM_verifyLen(eeprom));
+    if (result != E2PROM_Ok) {
+        eeprom->InTransmit = 0;
+        eeprom->InVerify   = 0;
+        E2PROM_verifyFailed(eeprom);
+    }
+}
+
+
+
+/**
+ * @brief compare read back with source of page, in E2PROM_readIRQ
+ *
+ * @param eeprom Address of E2PROM Struct
+ */
+static void E2PROM_verifyCheck(E2PROM* eeprom) {
+    uint8_t  len    = E2PROM_verifyLen(eeprom);
+#if E2PROM_USE_STAGING
+    uint8_t* source = eeprom->CommandHeaderInProcess.Type == E2PROM_Variable ? eeprom->Staging : eeprom->ConstVal;
+#else
+    uint8_t* source = eeprom->CommandHeaderInProcess.Type == E2PROM_Variable ? Stream_getReadPtr(&eeprom->WriteStream) : eeprom->ConstVal;
+#endif
+    if (E2PROM_assertMemory(eeprom->VerifyBuffer, source + eeprom->VerifyOffset, len) != 0) {
+        E2PROM_verifyFailed(eeprom);
+        return;
+    }
+    eeprom->VerifyOffset += len;
+    if (eeprom->VerifyOffset >= eeprom->TempLen) {
+        eeprom->VerifyPending = 0;
+        eeprom->VerifyRetries = 0;
+        E2PROM_pageDone(eeprom);
+    }
+}
+#endif
+
+
+
+/**
+ * @brief check ReadQueue and ReadStream have room for completion of read in process,
+ *        else read wait until older reads are given to callbacks
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint8_t
+ */
+static uint8_t E2PROM_readRoom(E2PROM* eeprom) {
+    if (Queue_space(&eeprom->ReadQueue) == 0) {
+        return 0;
+    }
+    if (Stream_directSpace(&eeprom->ReadStream) < eeprom->CommandHeaderInProcess.Len) {
+        if (Stream_available(&eeprom->ReadStream) > 0) {
+            return 0;
+        }
+        // stream is empty, start from its beginning for a contiguous room
+        Stream_clear(&eeprom->ReadStream);
+    }
+    return 1;
+}
+
+
+
+/**
+ * @brief give all completed reads of device to callbacks,
+ *        reads without callback are dropped so ReadStream never fill
+ *
+ * @param eeprom Address of E2PROM Struct
+ */
+static void E2PROM_drainReads(E2PROM* eeprom) {
+    E2PROM_CommandHeader header;
+    Stream               temp;
+    Stream_LenType       left;
+#if E2PROM_READ_BATCH
+    E2PROM_CommandHeader batch[E2PROM_READ_BATCH_SIZE];
+    uint16_t             batchLen;
+    uint8_t              count;
+    if (eeprom->onReadBatch != NULL) {
+        while (Queue_available(&eeprom->ReadQueue) > 0) {
+            count    = 0;
+            batchLen = 0;
+            while (count < E2PROM_READ_BATCH_SIZE && Queue_readItem(&eeprom->ReadQueue, &batch[count]) == Queue_Ok) {
+                batchLen += batch[count].Len;
+                count++;
+            }
+            Stream_lockRead(&eeprom->ReadStream, &temp, batchLen);
+            eeprom->onReadBatch(&temp, batch, count);
+            left = Stream_available(&temp);
+            Stream_unlockRead(&eeprom->ReadStream, &temp);
+            Stream_moveReadPos(&eeprom->ReadStream, left);
+        }
+        return;
+    }
+#endif
+    while (Queue_readItem(&eeprom->ReadQueue, &header) == Queue_Ok) {
+        if (eeprom->Callbacks.onRead != NULL && header.MemAddress < eeprom->Config->Size) {
+            Stream_lockRead(&eeprom->ReadStream, &temp, header.Len);
+            eeprom->Callbacks.onRead(&temp, header.MemAddress, header.Len);
+            // bytes callback did not read are skipped, next read start at its own data
+            left = Stream_available(&temp);
+            Stream_unlockRead(&eeprom->ReadStream, &temp);
+            Stream_moveReadPos(&eeprom->ReadStream, left);
+        }
+        else {
+            Stream_moveReadPos(&eeprom->ReadStream, header.Len);
+        }
+    }
+}
+
+
+
+#if E2PROM_USE_DEADLINE
+/**
+ * @brief earliest deadline of requests of device
+ *
+ * @param eeprom      Address of E2PROM Struct
+ * @param deadline    earliest deadline
+ * @param hasDeadline 0 if device has no request with deadline, deadline is not valid
+ * @return int8_t slot of earliest request that is not in process, -1 if there is not
+ */
+static int8_t E2PROM_deadlineEarliest(E2PROM* eeprom, E2PROM_Timestamp* deadline, uint8_t* hasDeadline) {
+    int8_t slot = -1;
+    *hasDeadline = eeprom->InUrgent;
+    *deadline    = eeprom->InUrgent ? eeprom->Urgent[eeprom->UrgentSlot].Deadline : 0;
+    for (uint8_t i = 0; i < E2PROM_DEADLINE_SLOTS; i++) {
+        if (eeprom->Urgent[i].Len > 0 && eeprom->Urgent[i].HasDeadline && !(eeprom->InUrgent && eeprom->UrgentSlot == i)) {
+            if (slot < 0 || __deadlineBefore(eeprom->Urgent[i].Deadline, eeprom->Urgent[slot].Deadline)) {
+                slot = (int8_t)i;
+            }
+            if (!*hasDeadline || __deadlineBefore(eeprom->Urgent[i].Deadline, *deadline)) {
+                *deadline    = eeprom->Urgent[i].Deadline;
+                *hasDeadline = 1;
+            }
+        }
+    }
+    return slot;
+}
+
+
+
+/**
+ * @brief device that has the earliest deadline
+ *
+ * @return E2PROM* E2PROM_NULL if no device has a request with deadline
+ */
+static E2PROM* E2PROM_deadlineDevice(void) {
+    E2PROM*          pE2PROM  = lastE2PROM;
+    E2PROM*          urgent   = E2PROM_NULL;
+    E2PROM_Timestamp earliest = 0;
+    E2PROM_Timestamp deadline;
+    uint8_t          hasDeadline;
+    while (pE2PROM != E2PROM_NULL) {
+        E2PROM_deadlineEarliest(pE2PROM, &deadline, &hasDeadline);
+        if (hasDeadline && (urgent == E2PROM_NULL || __deadlineBefore(deadline, earliest))) {
+            urgent   = pE2PROM;
+            earliest = deadline;
+        }
+        pE2PROM = pE2PROM->Previous;
+    }
+    return urgent;
+}
+
+
+
+/**
+ * @brief report missed deadlines, finish the request in process
+ *        and put the earliest request in process, command in process is paused between its pages
+ *
+ * @param eeprom Address of E2PROM Struct
+ */
+static void E2PROM_deadlineSchedule(E2PROM* eeprom) {
+    E2PROM_Timestamp now = eepromDriver->getTimestamp();
+    E2PROM_Timestamp deadline;
+    uint8_t          hasDeadline;
+    int8_t           slot;
+    for (uint8_t i = 0; i < E2PROM_DEADLINE_SLOTS; i++) {
+        if (eeprom->Urgent[i].Len > 0 && !(eeprom->UrgentMissed & (1 << i)) && __deadlineBefore(eeprom->Urgent[i].Deadline, now)) {
+            eeprom->UrgentMissed |= 1 << i;
+            if (eeprom->onDeadline != NULL) {
+                eeprom->onDeadline(eeprom, &eeprom->Urgent[i], E2PROM_TimeOutError);
+            }
+        }
+    }
+    if (eeprom->InUrgent) {
+        if (eeprom->CommandHeaderInProcess.Len > 0) {
+            return;
+        }
+        // request is done
+        if (!(eeprom->UrgentMissed & (1 << eeprom->UrgentSlot)) && eeprom->onDeadline != NULL) {
+            eeprom->onDeadline(eeprom, &eeprom->Urgent[eeprom->UrgentSlot], E2PROM_Ok);
+        }
+        eeprom->Urgent[eeprom->UrgentSlot].Len = 0;
+        eeprom->UrgentMissed                  &= ~(1 << eeprom->UrgentSlot);
+        eeprom->InUrgent                       = 0;
+        if (eeprom->Suspended.Len > 0) {
+            eeprom->CommandHeaderInProcess = eeprom->Suspended;
+            eeprom->ConstVal               = eeprom->SuspendedConstVal;
+            eeprom->Suspended.Len          = 0;
+#if E2PROM_WRITE_VERIFY
+            eeprom->VerifyFailed           = eeprom->SuspendedVerifyFailed;
+#endif
+        }
+    }
+    slot = E2PROM_deadlineEarliest(eeprom, &deadline, &hasDeadline);
+    if (slot < 0 || eeprom->InTransmit) {
+        return;
+    }
+#if E2PROM_WRITE_VERIFY
+    if (eeprom->VerifyPending) {
+        return;
+    }
+#endif
+#if E2PROM_USE_STAGING
+    // staged page is waiting to be programmed again
+    if (eeprom->Staged) {
+        return;
+    }
+#endif
+    if (eeprom->CommandHeaderInProcess.Len > 0) {
+        eeprom->Suspended         = eeprom->CommandHeaderInProcess;
+        eeprom->SuspendedConstVal = eeprom->ConstVal;
+#if E2PROM_WRITE_VERIFY
+        eeprom->SuspendedVerifyFailed = eeprom->VerifyFailed;
+        eeprom->VerifyFailed          = 0;
+#endif
+    }
+    eeprom->CommandHeaderInProcess = eeprom->Urgent[slot];
+    eeprom->ConstVal               = eeprom->UrgentData[slot];
+    eeprom->UrgentSlot             = (uint8_t)slot;
+    eeprom->InUrgent               = 1;
+}
+
+
+
+/**
+ * @brief put a request with deadline in a free slot of device
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param header header of request
+ * @param data   Address of Data for write
+ * @return E2PROM_Result E2PROM_Busy if all slots are in use
+ */
+static E2PROM_Result E2PROM_deadlineSubmit(E2PROM* eeprom, E2PROM_CommandHeader* header, uint8_t* data) {
+    for (uint8_t i = 0; i < E2PROM_DEADLINE_SLOTS; i++) {
+        if (eeprom->Urgent[i].Len == 0) {
+            eeprom->UrgentData[i] = data;
+            eeprom->Urgent[i]     = *header;
+            return E2PROM_Ok;
+        }
+    }
+    return E2PROM_Busy;
+}
+#endif
+
+
+
+/**
+ * @brief one step of state machine of a device
+ *
+ * @param pE2PROM Address of E2PROM Struct
+ * @return uint8_t return 1 if device has a command in process
+ */
+static uint8_t E2PROM_handleDevice (E2PROM* pE2PROM) {
+    uint16_t             len      = 0;
+    uint8_t              overPage = 0;
+    uint8_t allProcessDone = 0;
+    E2PROM_Result result;
+
+              if (!pE2PROM->Lock) {
+#if E2PROM_USE_DEADLINE
+                E2PROM_deadlineSchedule(pE2PROM);
+#endif
+                if (Queue_available(&pE2PROM->CommandQueue) > 0 && pE2PROM->CommandHeaderInProcess.Len == 0) {
+                    Queue_readItem(&pE2PROM->CommandQueue, &pE2PROM->CommandHeaderInProcess);
+                    if (pE2PROM->CommandHeaderInProcess.Type == E2PROM_Const) {
+                        switch (pE2PROM->CommandHeaderInProcess.Mode) {
+                            case E2PROM_WriteMode:
+                                Stream_readBytes(&pE2PROM->WriteStream, (uint8_t*)&pE2PROM->ConstVal, sizeof(pE2PROM->ConstVal));
+                                break;
+                            case E2PROM_EraseMode:
+                                pE2PROM->ConstVal = (uint8_t*)E2PROM_PAGE;
+                                break;
+                        }
+                    }
+                }
+
+                E2PROM_drainReads(pE2PROM);
+
+#if E2PROM_USE_POOL
+                E2PROM_poolGiveBack(pE2PROM);
+#endif
+
+#if E2PROM_WEAR_TRACKING
+                // a save refused for space is continued here, page by page
+                if (pE2PROM->WearMap != NULL && pE2PROM->WearPeriod > 0 && (pE2PROM->WearPending >= pE2PROM->WearPeriod || pE2PROM->WearSaveOffset > 0) &&
+                    pE2PROM->CommandHeaderInProcess.Len == 0 && Queue_available(&pE2PROM->CommandQueue) == 0) {
+                    E2PROM_wearSave(pE2PROM);
+                }
+#endif
+
+#if E2PROM_WRITE_VERIFY
+                if (pE2PROM->VerifyPending) {
+                    allProcessDone = 1;
+                    E2PROM_verifyRead(pE2PROM);
+                }
+                else
+#endif
+                if (pE2PROM->CommandHeaderInProcess.Len > 0 && pE2PROM->CommandHeaderInProcess.MemAddress <= pE2PROM->Config->Size) {
+                    allProcessDone = 1;
+                    switch (pE2PROM->CommandHeaderInProcess.Mode) {
+                        case E2PROM_WriteMode:
+                            if (pE2PROM->NextTick < eepromDriver->getTimestamp()) {
+                                switch (pE2PROM->CommandHeaderInProcess.Type) {
+                                    case E2PROM_Const:
+                                        overPage         = (pE2PROM->CommandHeaderInProcess.Len > pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize)) ? 1 : 0;
+                                        pE2PROM->TempLen = overPage ? pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize) : pE2PROM->CommandHeaderInProcess.Len;
+                                        if (pE2PROM->InTransmit != 1) {
+                                          pE2PROM->InTransmit = 1;
+                                          result = E2PROM_pageWrite(pE2PROM, pE2PROM->CommandHeaderInProcess.Mode, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->ConstVal, pE2PROM->TempLen);
+                                          if (result != E2PROM_Ok) {
+                                            if (pE2PROM->Callbacks.onWriteError != NULL) {
+                                              pE2PROM->Callbacks.onWriteError (&pE2PROM->WriteStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
+                                            }
+                                          }
+                                        }
+                                        break;
+
+                                    case E2PROM_Variable:
+#if E2PROM_USE_STAGING
+                                        // whole page is copied to Staging, wrap of WriteStream don't split it
+                                        if (!pE2PROM->Staged) {
+                                            len              = pE2PROM->CommandHeaderInProcess.Len > E2PROM_STAGING_SIZE ? E2PROM_STAGING_SIZE : pE2PROM->CommandHeaderInProcess.Len;
+                                            overPage         = (len > pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize)) ? 1 : 0;
+                                            pE2PROM->TempLen = overPage ? pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize) : len;
+                                            Stream_readBytes(&pE2PROM->WriteStream, pE2PROM->Staging, pE2PROM->TempLen);
+                                            pE2PROM->Staged  = 1;
+                                        }
+#else
+                                        len              = (pE2PROM->CommandHeaderInProcess.Len > Stream_directAvailable(&pE2PROM->WriteStream)) ? Stream_directAvailable(&pE2PROM->WriteStream) : pE2PROM->CommandHeaderInProcess.Len;
+                                        overPage         = (len > pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize)) ? 1 : 0;
+                                        pE2PROM->TempLen = overPage ? pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize) : len;
+#endif
+                                        if (pE2PROM->InTransmit != 1) {
+                                          pE2PROM->InTransmit = 1;
+#if E2PROM_USE_STAGING
+                                          result = E2PROM_pageWrite(pE2PROM, pE2PROM->CommandHeaderInProcess.Mode, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->Staging, pE2PROM->TempLen);
+#else
+                                          result = E2PROM_pageWrite(pE2PROM, pE2PROM->CommandHeaderInProcess.Mode, pE2PROM->CommandHeaderInProcess.MemAddress, Stream_getReadPtr(&pE2PROM->WriteStream), pE2PROM->TempLen);
+#endif
+                                          if (result != E2PROM_Ok) {
+                                            if (pE2PROM->Callbacks.onWriteError != NULL) {
+                                                pE2PROM->Callbacks.onWriteError (&pE2PROM->WriteStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
+                                            }
+                                          }
+                                        }
+                                        break;
+                                }
+                                pE2PROM->NextTick = eepromDriver->getTimestamp() + pE2PROM->Config->WriteDelayTime;
+                            }
+                            break;
+
+                        case E2PROM_ReadMode:
+                          if (pE2PROM->NextTick < eepromDriver->getTimestamp() && pE2PROM->CommandHeaderInProcess.Len > 0 && pE2PROM->InTransmit == 0 &&
+                              E2PROM_readRoom(pE2PROM)) {
+                            pE2PROM->InTransmit = 1;  
+                            //eepromDriver->delayMs(10);
+                            result = E2PROM_busRead (pE2PROM, pE2PROM->CommandHeaderInProcess.MemAddress, Stream_getWritePtr(&pE2PROM->ReadStream), pE2PROM->CommandHeaderInProcess.Len);
+                            if (result != E2PROM_Ok) {
+                              // no IRQ will come, drop the read so device can go on
+                              pE2PROM->InTransmit                 = 0;
+                              len                                 = pE2PROM->CommandHeaderInProcess.Len;
+                              pE2PROM->CommandHeaderInProcess.Len = 0;
+                              if (pE2PROM->Callbacks.onReadError != NULL) {
+                                  pE2PROM->Callbacks.onReadError(&pE2PROM->ReadStream, pE2PROM->CommandHeaderInProcess.MemAddress, len); 
+                              }
+                            }
+                            pE2PROM->NextTick = eepromDriver->getTimestamp() + pE2PROM->Config->WriteDelayTime;
+                          }
+                          break;
+
+                        case E2PROM_EraseMode:
+                            if (pE2PROM->NextTick < eepromDriver->getTimestamp() && pE2PROM->InTransmit == 0) {
+                                overPage         = (pE2PROM->CommandHeaderInProcess.Len > pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize)) ? 1 : 0;
+                                pE2PROM->TempLen = overPage ? pE2PROM->Config->PageSize - (pE2PROM->CommandHeaderInProcess.MemAddress % pE2PROM->Config->PageSize) : pE2PROM->CommandHeaderInProcess.Len;
+                                pE2PROM->InTransmit = 1;
+                                result = E2PROM_pageWrite(pE2PROM, pE2PROM->CommandHeaderInProcess.Mode, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->ConstVal, pE2PROM->TempLen);
+                                if (result != E2PROM_Ok && pE2PROM->Callbacks.onWriteError != NULL) {
+                                    pE2PROM->Callbacks.onWriteError (&pE2PROM->WriteStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
+                                }
+                                pE2PROM->NextTick = eepromDriver->getTimestamp() + pE2PROM->Config->WriteDelayTime;
+                            }
+                            break;
+
+                        case E2PROM_NoiseEraseMode:
+                            if (pE2PROM->NextTick < eepromDriver->getTimestamp() && pE2PROM->InTransmit == 0) {
+                                for (uint8_t i = 0; i < pE2PROM->Config->PageSize / 4; i++) {
+                                    Stream_writeUInt32(&pE2PROM->NoiseEraseStream, eepromDriver->rand());
+                                }
+                                pE2PROM->InTransmit = 1;
+                                result = E2PROM_pageWrite(pE2PROM, pE2PROM->CommandHeaderInProcess.Mode, pE2PROM->CommandHeaderInProcess.MemAddress, Stream_getReadPtr(&pE2PROM->NoiseEraseStream), pE2PROM->Config->PageSize);
+                                if (result != E2PROM_Ok) {
+                                    if (pE2PROM->Callbacks.onWriteError != NULL) {
+                                        pE2PROM->Callbacks.onWriteError (&pE2PROM->WriteStream, pE2PROM->CommandHeaderInProcess.MemAddress, pE2PROM->CommandHeaderInProcess.Len); 
+                                    }
+                                }
+                                pE2PROM->NextTick = eepromDriver->getTimestamp() + pE2PROM->Config->WriteDelayTime;
+                            }
+                            break;
+                      }
+                   }
+                }
+    return allProcessDone;
+}
+
+
+
+/**
+ * @brief E2PROM Handle , this function can use in your interrupt and while(1) for handle nonBlocking function
+ *
+ * @param eeprom Address of your E2PROM Struct
+ */
+uint8_t E2PROM_handle (void) {
+    E2PROM* pE2PROM        = lastE2PROM;
+    uint8_t allProcessDone = 0;
+#if E2PROM_USE_DEADLINE
+    E2PROM* urgent         = E2PROM_deadlineDevice();
+#endif
+    
+#if E2PROM_CHECK_ENABLE
+    if (pE2PROM->Enabled) {
+#endif
+#if E2PROM_USE_DEADLINE
+            // device with earliest deadline take the bus first
+            if (urgent != E2PROM_NULL) {
+                allProcessDone |= E2PROM_handleDevice(urgent);
+            }
+#endif
+            while (pE2PROM != E2PROM_NULL) {
+#if E2PROM_USE_DEADLINE
+                if (pE2PROM == urgent) {
+                    pE2PROM = pE2PROM->Previous;
+                    continue;
+                }
+#endif
+                allProcessDone |= E2PROM_handleDevice(pE2PROM);
+                pE2PROM = pE2PROM->Previous;
+    }
+    return allProcessDone;
+#if E2PROM_CHECK_ENABLE
+    }
+#endif
+}
+
+
+
+/**
+ * @brief this function must be in HAL_I2C_MemTxCpltCallback
+ *
+ * @param eeprom
+ */
+void E2PROM_writeIRQ (E2PROM* eeprom) {
+#if E2PROM_TRACE
+  // address of blocking functions is not in CommandHeaderInProcess
+  E2PROM_trace(eeprom, E2PROM_TraceWriteIRQ, eeprom->CommandHeaderInProcess.Mode,
+               eeprom->Lock ? 0 : eeprom->CommandHeaderInProcess.MemAddress, eeprom->Lock ? 0 : eeprom->TempLen, NULL);
+#endif
+  eeprom->InTransmit = 0;  
+  if (!eeprom->Lock) {
+#if E2PROM_WRITE_VERIFY
+        if (eeprom->CommandHeaderInProcess.Mode != E2PROM_NoiseEraseMode) {
+            // handle read it back when write cycle is finished, then go to next page
+            eeprom->VerifyPending = 1;
+            eeprom->VerifyOffset  = 0;
+            return;
+        }
+#endif
+        E2PROM_pageDone(eeprom);
+    } else {
+        eeprom->InBlocking = 0;
+        if (eepromDriver->signal != NULL) {
+            eepromDriver->signal(eeprom);
+        }
+    }
+}
+
+
+/**
+ * @brief this function must be in HAL_I2C_MemRxCpltCallback
+ *
+ * @param eeprom
+ */
+void E2PROM_readIRQ (E2PROM* eeprom) {
+#if E2PROM_TRACE
+  E2PROM_trace(eeprom, E2PROM_TraceReadIRQ, E2PROM_ReadMode,
+               eeprom->Lock ? 0 : eeprom->CommandHeaderInProcess.MemAddress, eeprom->Lock ? 0 : eeprom->CommandHeaderInProcess.Len, NULL);
+#endif
+  eeprom->InTransmit = 0;
+#if E2PROM_WRITE_VERIFY
+    if (eeprom->InVerify) {
+        eeprom->InVerify = 0;
+        E2PROM_verifyCheck(eeprom);
+        return;
+    }
+#endif
+    if (!eeprom->Lock && eeprom->CommandHeaderInProcess.Len > 0) {
+        Stream_moveWritePos (&eeprom->ReadStream, eeprom->CommandHeaderInProcess.Len);
+        Queue_writeItem(&eeprom->ReadQueue, &eeprom->CommandHeaderInProcess);
+        eeprom->CommandHeaderInProcess.Len = 0;
+    }
+    else {
+        eeprom->InBlocking = 0;
+        if (eepromDriver->signal != NULL) {
+            eepromDriver->signal(eeprom);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Blocking Write Functions
+ *
+ * @param eeprom Address of your E2PROM struct
+ * @param data Address of your Data u want to store in E2PROM Chip
+ * @param addr Address of E2PROM Chip u want to store data in it
+ * @param len Length of your Data
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROM_writeBlocking (E2PROM* eeprom, uint16_t addr, void* data, uint16_t len) {
+    E2PROM_CommandHeader cacheHeader;
+    uint8_t              overPage = 0;
+    uint8_t              tempLen;
+    E2PROM_Result        result;
+    if ((addr <= eeprom->Config->Size) && (len <= eeprom->Config->Size) && (len > 0)) {
+        cacheHeader.MemAddress = addr;
+        cacheHeader.Len        = len;
+    } else {
+        return E2PROM_HeaderValueError;
+    }
+    eeprom->InBlocking = 1;
+    eeprom->Lock       = 1;
+    while (cacheHeader.Len > 0) {
+        overPage           = cacheHeader.Len > eeprom->Config->PageSize - (cacheHeader.MemAddress % eeprom->Config->PageSize) ? 1 : 0;
+        tempLen            = overPage ? eeprom->Config->PageSize - (cacheHeader.MemAddress % eeprom->Config->PageSize) : cacheHeader.Len;
+        eeprom->InBlocking = 1;
+        result = E2PROM_pageWrite(eeprom, E2PROM_WriteMode, cacheHeader.MemAddress, data, tempLen);
+        if (result != E2PROM_Ok) {
+           if (eeprom->Callbacks.onWriteError != NULL) {
+              eeprom->Callbacks.onWriteError (&eeprom->WriteStream, cacheHeader.MemAddress, cacheHeader.Len);
+           }
+           eeprom->InBlocking = 0;
+           eeprom->Lock       = 0;
+           return result;
+        }
+#if E2PROM_USE_INTERRUPT_I2C
+        result = E2PROM_waitBlocking(eeprom);
+        if (result != E2PROM_Ok) {
+            eeprom->Lock = 0;
+            return result;
+        }
+#endif
+        cacheHeader.Len        -= tempLen;
+        data += tempLen;
+        cacheHeader.MemAddress += tempLen;
+        eepromDriver->delayMs (eeprom->Config->WriteDelayTime);
+    }
+    eeprom->Lock = 0;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief E2PROM
+ *
+ * @param eeprom Address of your E2PROM struct
+ * @param data Address of your Data u want to store in E2PROM Chip
+ * @param addr Address of E2PROM Chip u want to store data in it
+ * @param len  length of Data
+ * @param type Data Type (Const or Variable)
+ * @return E2PROM_Result E2PROM_HeaderValueError if Data is bigger than WriteStream
+ */
+E2PROM_Result E2PROM_write (E2PROM* eeprom, uint16_t addr, uint8_t* data, uint16_t len, E2PROM_DataType type) {
+    E2PROM_CommandHeader cacheHeader;
+    E2PROM_Result        result;
+    // Const data is not copied, only its address goes to WriteStream
+    uint16_t             streamLen = type == E2PROM_Const ? sizeof(eeprom->ConstVal) : len;
+    if ((addr < eeprom->Config->Size) && (len > 0)) {
+#if E2PROM_USE_POOL
+        if (E2PROM_poolSubmit(eeprom, E2PROM_WriteMode, streamLen) != E2PROM_Ok) {
+            return E2PROM_Busy;
+        }
+#endif
+        // a write bigger than WriteStream never can be queued, command and its data must be accepted together
+        result = streamLen > Stream_space(&eeprom->WriteStream) + Stream_available(&eeprom->WriteStream) ? E2PROM_HeaderValueError :
+                 Queue_space(&eeprom->CommandQueue) == 0 || Stream_space(&eeprom->WriteStream) < streamLen ? E2PROM_Busy : E2PROM_Ok;
+        if (result != E2PROM_Ok) {
+#if E2PROM_USE_POOL
+            E2PROM_poolCancel(eeprom);
+#endif
+            return result;
+        }
+        cacheHeader.MemAddress = addr;
+        cacheHeader.Len        = len;
+        cacheHeader.Type       = type;
+        cacheHeader.Mode       = E2PROM_WriteMode;
+#if E2PROM_USE_DEADLINE
+        cacheHeader.HasDeadline = 0;
+#endif
+        Queue_writeItem(&eeprom->CommandQueue, &cacheHeader);
+
+        if (cacheHeader.Type == E2PROM_Const) {
+            Stream_writeBytes(&eeprom->WriteStream, (uint8_t*)&data, sizeof(eeprom->ConstVal));
+        } else {
+            Stream_writeBytes(&eeprom->WriteStream, data, cacheHeader.Len);
+        }
+#if E2PROM_USE_POOL
+        poolSubmit = 0;
+#endif
+//        eeprom->WriteReady = 1;
+        return E2PROM_Ok;
+    } else {
+        return E2PROM_HeaderValueError;
+    }
+}
+
+
+
+/**
+ * @brief this function use for read from E2PROM Chip
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param buffer buffer u want to store ReadValue in it
+ * @param addr Address of E2PROM u want to Read from that Address
+ * @param len Length of your DataValue
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROM_read (E2PROM* eeprom, uint16_t addr, uint8_t len) {
+    E2PROM_CommandHeader cacheHeader;
+    E2PROM_Result        result;
+    if ((addr < eeprom->Config->Size) && (len > 0) && (len <= eeprom->Config->Size)) {
+#if E2PROM_USE_POOL
+        if (E2PROM_poolSubmit(eeprom, E2PROM_ReadMode, len) != E2PROM_Ok) {
+            return E2PROM_Busy;
+        }
+#endif
+        // a read bigger than ReadStream never can be done
+        result = len > Stream_space(&eeprom->ReadStream) + Stream_available(&eeprom->ReadStream) ? E2PROM_HeaderValueError :
+                 Queue_space(&eeprom->CommandQueue) == 0 ? E2PROM_Busy : E2PROM_Ok;
+        if (result != E2PROM_Ok) {
+#if E2PROM_USE_POOL
+            E2PROM_poolCancel(eeprom);
+#endif
+            return result;
+        }
+        cacheHeader.MemAddress = addr;
+        cacheHeader.Len        = len;
+        cacheHeader.Type       = E2PROM_Variable;
+        cacheHeader.Mode       = E2PROM_ReadMode;
+#if E2PROM_USE_DEADLINE
+        cacheHeader.HasDeadline = 0;
+#endif
+        Queue_writeItem (&eeprom->CommandQueue, &cacheHeader);
+#if E2PROM_USE_POOL
+        poolSubmit = 0;
+#endif
+        return E2PROM_Ok;
+    } else {
+        return E2PROM_HeaderValueError;
+    }
+}
+
+
+
+/**
+ * @brief E2PROM_write, if E2PROM is full run E2PROM_handle until it has space, must not be used in callbacks or interrupt
+ *
+ * @param eeprom  Address of E2PROM Struct
+ * @param addr    Address of E2PROM Chip
+ * @param data    Address of Data
+ * @param len     Length of Data
+ * @param type    E2PROM_DataType
+ * @param timeout max time to wait for space
+ * @return E2PROM_Result E2PROM_TimeOutError if space is not free in timeout
+ */
+E2PROM_Result E2PROM_writeWait (E2PROM* eeprom, uint16_t addr, uint8_t* data, uint16_t len, E2PROM_DataType type, E2PROM_Timestamp timeout) {
+    E2PROM_Timestamp time = eepromDriver->getTimestamp() + timeout;
+    E2PROM_Result    result;
+    while ((result = E2PROM_write(eeprom, addr, data, len, type)) == E2PROM_Busy) {
+        if (!__deadlineBefore(eepromDriver->getTimestamp(), time)) {
+            return E2PROM_TimeOutError;
+        }
+        E2PROM_handle();
+    }
+    return result;
+}
+
+
+
+/**
+ * @brief E2PROM_read, if E2PROM is full run E2PROM_handle until it has space, must not be used in callbacks or interrupt
+ *
+ * @param eeprom  Address of E2PROM Struct
+ * @param addr    Address of E2PROM Chip
+ * @param len     Length of Data
+ * @param timeout max time to wait for space
+ * @return E2PROM_Result E2PROM_TimeOutError if space is not free in timeout
+ */
+E2PROM_Result E2PROM_readWait (E2PROM* eeprom, uint16_t addr, uint8_t len, E2PROM_Timestamp timeout) {
+    E2PROM_Timestamp time = eepromDriver->getTimestamp() + timeout;
+    E2PROM_Result    result;
+    while ((result = E2PROM_read(eeprom, addr, len)) == E2PROM_Busy) {
+        if (!__deadlineBefore(eepromDriver->getTimestamp(), time)) {
+            return E2PROM_TimeOutError;
+        }
+        E2PROM_handle();
+    }
+    return result;
+}
+
+
+
+#if E2PROM_USE_DEADLINE
+/**
+ * @brief NonBlocking write that must be done in a time, it is done before other commands of device
+ *        and a command in process is paused after its current page
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param addr   Address of E2PROM Chip
+ * @param data   Address of Data, it is not copied and must be valid until onDeadline is called
+ * @param len    Length of Data
+ * @param within time from now the write must be done in it
+ * @return E2PROM_Result E2PROM_Busy if all E2PROM_DEADLINE_SLOTS are in use
+ */
+E2PROM_Result E2PROM_writeDeadline (E2PROM* eeprom, uint16_t addr, uint8_t* data, uint16_t len, E2PROM_Timestamp within) {
+    E2PROM_CommandHeader cacheHeader;
+    if ((addr < eeprom->Config->Size) && (len > 0)) {
+        cacheHeader.MemAddress = addr;
+        cacheHeader.Len        = len;
+        cacheHeader.Type       = E2PROM_Const;
+        cacheHeader.Mode       = E2PROM_WriteMode;
+        cacheHeader.Deadline   = eepromDriver->getTimestamp() + within;
+        cacheHeader.HasDeadline = 1;
+        return E2PROM_deadlineSubmit(eeprom, &cacheHeader, data);
+    } else {
+        return E2PROM_HeaderValueError;
+    }
+}
+
+
+
+/**
+ * @brief NonBlocking read that must be done in a time, data come to onRead like E2PROM_read
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param addr   Address of E2PROM Chip
+ * @param len    Length of Data
+ * @param within time from now the read must be done in it
+ * @return E2PROM_Result E2PROM_Busy if all E2PROM_DEADLINE_SLOTS are in use
+ */
+E2PROM_Result E2PROM_readDeadline (E2PROM* eeprom, uint16_t addr, uint8_t len, E2PROM_Timestamp within) {
+    E2PROM_CommandHeader cacheHeader;
+    E2PROM_Result        result;
+    if ((addr < eeprom->Config->Size) && (len > 0)) {
+#if E2PROM_USE_POOL
+        if (E2PROM_poolSubmit(eeprom, E2PROM_ReadMode, len) != E2PROM_Ok) {
+            return E2PROM_Busy;
+        }
+#endif
+        cacheHeader.MemAddress = addr;
+        cacheHeader.Len        = len;
+        cacheHeader.Type       = E2PROM_Variable;
+        cacheHeader.Mode       = E2PROM_ReadMode;
+        cacheHeader.Deadline   = eepromDriver->getTimestamp() + within;
+        cacheHeader.HasDeadline = 1;
+        result = len > Stream_space(&eeprom->ReadStream) + Stream_available(&eeprom->ReadStream) ? E2PROM_HeaderValueError :
+                 E2PROM_deadlineSubmit(eeprom, &cacheHeader, NULL);
+#if E2PROM_USE_POOL
+        if (result != E2PROM_Ok) {
+            E2PROM_poolCancel(eeprom);
+        } else {
+            poolSubmit = 0;
+        }
+#endif
+        return result;
+    } else {
+        return E2PROM_HeaderValueError;
+    }
+}
+
+
+
+/**
+ * @brief Callback Func, called when a request with deadline is done in time (E2PROM_Ok)
+ *        or its deadline is passed (E2PROM_TimeOutError), a late request is still done
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param cb
+ */
+void E2PROM_onDeadline (E2PROM* eeprom, E2PROM_DeadlineFn cb) {
+    eeprom->onDeadline = cb;
+}
+#endif
+
+
+
+/**
+ * @brief number of commands E2PROM can take now
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return E2PROM_LenType
+ */
+E2PROM_LenType E2PROM_commandSpace (E2PROM* eeprom) {
+    return (E2PROM_LenType)Queue_space(&eeprom->CommandQueue);
+}
+
+
+
+/**
+ * @brief bytes E2PROM_write can take now without E2PROM_Busy, a device on pool can borrow more
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return E2PROM_LenType
+ */
+E2PROM_LenType E2PROM_writeSpace (E2PROM* eeprom) {
+    return Queue_space(&eeprom->CommandQueue) > 0 ? (E2PROM_LenType)Stream_space(&eeprom->WriteStream) : 0;
+}
+
+
+
+/**
+ * @brief
+ *
+ * @param eeprom   address of eeprom struct
+ * @param addr     address of eeprom u want to read
+ * @param val      address of buffer u want to store Data in that
+ * @param len      length of Data
+ * @return         E2PROM_Result
+ */
+E2PROM_Result E2PROM_readBlocking (E2PROM* eeprom, uint16_t addr, uint8_t* val, uint16_t len) {
+  E2PROM_Result result;  
+  if ((addr < eeprom->Config->Size) && (len > 0) && (len < eeprom->Config->Size)) {
+        eeprom->Lock       = 1;
+        eeprom->InBlocking = 1;
+      if (eeprom->InTransmit == 0) {
+        eeprom->InTransmit = 1;  
+        result = E2PROM_busRead(eeprom, addr, val, len);
+        if (result != E2PROM_Ok) {
+            if (eeprom->Callbacks.onReadError != NULL) {
+                eeprom->Callbacks.onReadError (&eeprom->ReadStream, addr, len);
+            }
+            eeprom->InTransmit = 0;
+            eeprom->InBlocking = 0;
+            eeprom->Lock       = 0;
+            return result;
+        }
+      }
+#if E2PROM_USE_INTERRUPT_I2C
+        result = E2PROM_waitBlocking(eeprom);
+        if (result != E2PROM_Ok) {
+            eeprom->Lock = 0;
+            return result;
+        }
+#endif
+        eeprom->Lock = 0;
+        return E2PROM_Ok;
+    } else {
+        return E2PROM_HeaderValueError;
+    }
+}
+
+
+
+/**
+ * @brief E2PROM NonBlocking erase  
+ *
+ * @param eeprom
+ * @return E2PROM_Result E2PROM_Busy if CommandQueue is full
+ */
+E2PROM_Result E2PROM_erase (E2PROM* eeprom) {
+    E2PROM_CommandHeader cacheHeader;
+#if E2PROM_USE_POOL
+    if (E2PROM_poolSubmit(eeprom, E2PROM_EraseMode, 0) != E2PROM_Ok) {
+        return E2PROM_Busy;
+    }
+#endif
+    if (Queue_space(&eeprom->CommandQueue) == 0) {
+#if E2PROM_USE_POOL
+        E2PROM_poolCancel(eeprom);
+#endif
+        return E2PROM_Busy;
+    }
+    cacheHeader.Len        = eeprom->Config->Size;
+    cacheHeader.MemAddress = 0;
+    cacheHeader.Mode       = E2PROM_EraseMode;
+    cacheHeader.Type       = E2PROM_Const;
+#if E2PROM_USE_DEADLINE
+    cacheHeader.HasDeadline = 0;
+#endif
+    Queue_writeItem (&eeprom->CommandQueue, &cacheHeader);
+#if E2PROM_USE_POOL
+    poolSubmit = 0;
+#endif
+    return E2PROM_Ok;
+}
+
+
+
+
+/**
+ * @brief get E2PROM Config
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return const E2PROM_Config*
+ */
+const E2PROM_Config* E2PROM_getConfig (E2PROM* eeprom) {
+    return eeprom->Config;
+}
+
+
+
+
+/**
+ * @brief Set user Argument
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param args
+ */
+void StatusLed_setArgs (E2PROM* eeprom, void* args) {
+    eeprom->Args = args;
+}
+
+
+
+/**
+ * @brief get User Argument
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return void*
+ */
+void* E2PROM_getArgs (E2PROM* eeprom) {
+    return eeprom->Args;
+}
+
+
+
+
+/**
+ * @brief Callback Func, called when last page of a nonBlocking write is done (in writeIRQ when E2PROM_WRITE_VERIFY is 0),
+ *        addr and len are of the last page
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param cb
+ */
+void E2PROM_onWrite (E2PROM* eeprom, E2PROM_CallbackFn cb) {
+    eeprom->Callbacks.onAfterWrite = cb;
+}
+
+
+
+/**
+ * @brief Callback Func
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param cb
+ */
+void E2PROM_onRead (E2PROM* eeprom, E2PROM_CallbackFn cb) {
+    eeprom->Callbacks.onRead = cb;
+}
+
+
+/**
+ * @brief Callback Func
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param cb
+ */
+void E2PROM_onReadError (E2PROM* eeprom, E2PROM_CallbackFn cb) {
+    eeprom->Callbacks.onReadError = cb;
+}
+
+
+/**
+ * @brief Callback Func
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param cb
+ */
+void E2PROM_onWriteError (E2PROM* eeprom, E2PROM_CallbackFn cb) {
+    eeprom->Callbacks.onWriteError = cb;
+}
+
+
+#if E2PROM_READ_BATCH
+/**
+ * @brief Callback Func, when it is set onRead is not called
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param cb
+ */
+void E2PROM_onReadBatch (E2PROM* eeprom, E2PROM_ReadBatchFn cb) {
+    eeprom->onReadBatch = cb;
+}
+#endif
+
+
+/**
+ * @brief Add another E2PROM to the Process
+ *
+ * @param eeprom Address of New E2PROM Struct
+ * @param config Address of New E2PROM Config
+ * @return E2PROM_Result E2PROM_HeaderValueError if a page of device does not fit in Staging
+ */
+E2PROM_Result E2PROM_add (E2PROM* eeprom, const E2PROM_Config* config) {
+    // check for null
+    if (E2PROM_NULL == eeprom) {
+        return E2PROM_Null;
+    }
+#if E2PROM_USE_STAGING
+    // a page is programmed from Staging, a bigger page would be cut
+    if (config->PageSize > E2PROM_STAGING_SIZE) {
+        return E2PROM_HeaderValueError;
+    }
+#endif
+    E2PROM_setConfig(eeprom, config);
+
+    // add E2PROM to linked list
+    eeprom->Previous   = __eeprom();
+    lastE2PROM         = eeprom;
+    eeprom->Configured = 1;
+#if E2PROM_TRACE
+    eeprom->TraceId    = traceNextId++;
+#endif
+
+#if E2PROM_CHECK_ENABLE
+    eeprom->Enabled    = 1;
+#endif
+
+    return E2PROM_Ok;
+}
+
+
+
+
+/**
+ * @brief Remove the E2PROM
+ *
+ * @param remove Address of E2PROM Struct user Want to remove that
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROM_remove (E2PROM* remove) {
+
+    E2PROM* pE2PROM = __eeprom();
+    if (remove == pE2PROM) {
+        lastE2PROM = remove->Previous;
+        remove->Previous   = E2PROM_NULL;
+        remove->Configured = 0;
+        remove->Enabled    = 0;
+        return E2PROM_Ok;
+    }
+    while (E2PROM_NULL != pE2PROM) {
+        if (remove == pE2PROM->Previous) {
+            pE2PROM->Previous  = remove->Previous;
+            remove->Previous   = E2PROM_NULL;
+            remove->Configured = 0;
+            remove->Enabled    = 0;
+            return E2PROM_Ok;
+        }
+        pE2PROM = pE2PROM->Previous;
+    }
+    return E2PROM_Error;
+}
+
+
+#if E2PROM_CHECK_ENABLE
+/**
+ * @brief set enable/disable eeprom
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param enabled
+ */
+void E2PROM_setEnabled (E2PROM* eeprom, uint8_t enabled) {
+    eeprom->Enabled = enabled;
+}
+
+/**
+ * @brief return 1 if Enable and 0 if Disable
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint8_t
+ */
+uint8_t E2PROM_isEnabled (E2PROM* eeprom) {
+    return eeprom->Enabled;
+}
+
+#endif
+
+
+
+#if E2PROM_WEAR_TRACKING
+/**
+ * @brief start tracking program cycles of each page, call after E2PROM_add
+ *        WearMap persisted in two slots with sequence and crc at persistAddress, it needs E2PROM_wearRegionSize bytes,
+ *        WearMap is queued page by page, so WriteStream must hold at least a page
+ *
+ * @param eeprom         Address of E2PROM Struct
+ * @param map            counter for each page, Size / PageSize entries
+ * @param persistAddress Address of reserved region for WearMap
+ * @param period         persist WearMap from E2PROM_handle after this number of page programs, 0 for disable
+ */
+void E2PROM_wearInit(E2PROM* eeprom, E2PROM_WearCounter* map, uint16_t persistAddress, uint16_t period) {
+    memset(map, 0, E2PROM_wearPages(eeprom) * sizeof(E2PROM_WearCounter));
+    eeprom->WearMap        = map;
+    eeprom->WearAddress    = persistAddress;
+    eeprom->WearPeriod     = period;
+    eeprom->WearPending    = 0;
+    eeprom->WearSeq        = 0;
+    eeprom->WearSession    = 0;
+    eeprom->WearStartTime  = eepromDriver->getTimestamp();
+    eeprom->WearSaveOffset = 0;
+}
+
+/**
+ * @brief number of pages of E2PROM
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint16_t
+ */
+uint16_t E2PROM_wearPages(E2PROM* eeprom) {
+    return eeprom->Config->Size / eeprom->Config->PageSize;
+}
+
+/**
+ * @brief bytes of a slot, WearMap then sequence and crc
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint16_t
+ */
+static uint16_t E2PROM_wearSlotSize(E2PROM* eeprom) {
+    return E2PROM_wearPages(eeprom) * sizeof(E2PROM_WearCounter) + 2 * sizeof(uint16_t);
+}
+
+/**
+ * @brief bytes of reserved region for persist WearMap, two slots
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint16_t
+ */
+uint16_t E2PROM_wearRegionSize(E2PROM* eeprom) {
+    return 2 * E2PROM_wearSlotSize(eeprom);
+}
+
+/**
+ * @brief check a slot on the chip, map is read in chunks
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param slot   0 or 1
+ * @param seq    sequence of slot
+ * @return E2PROM_Result return E2PROM_Error if crc of slot is not same
+ */
+static E2PROM_Result E2PROM_wearCheckSlot(E2PROM* eeprom, uint8_t slot, uint16_t* seq) {
+    uint8_t       chunk[32];
+    uint16_t      trailer[2]; /**< sequence and crc */
+    uint16_t      addr = eeprom->WearAddress + slot * E2PROM_wearSlotSize(eeprom);
+    uint16_t      len  = E2PROM_wearPages(eeprom) * sizeof(E2PROM_WearCounter);
+    uint16_t      crc  = E2PROM_CRC_INIT;
+    uint16_t      part;
+    E2PROM_Result result;
+    for (uint16_t offset = 0; offset < len; offset += part) {
+        part   = len - offset > (uint16_t)sizeof(chunk) ? (uint16_t)sizeof(chunk) : len - offset;
+        result = E2PROM_readBlocking(eeprom, addr + offset, chunk, part);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+        crc = E2PROMCrc_update(crc, chunk, part);
+    }
+    result = E2PROM_readBlocking(eeprom, addr + len, (uint8_t*)trailer, sizeof(trailer));
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    *seq = trailer[0];
+    return E2PROMCrc_update(crc, (const uint8_t*)&trailer[0], sizeof(trailer[0])) == trailer[1] ? E2PROM_Ok : E2PROM_Error;
+}
+
+/**
+ * @brief restore WearMap from newest valid slot of reserved region, Blocking
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return E2PROM_Result return E2PROM_Error if no saved map is valid, WearMap is not changed
+ */
+E2PROM_Result E2PROM_wearLoad(E2PROM* eeprom) {
+    uint16_t      seq[2];
+    uint8_t       valid[2];
+    uint8_t       slot;
+    E2PROM_Result result;
+    for (slot = 0; slot < 2; slot++) {
+        valid[slot] = E2PROM_wearCheckSlot(eeprom, slot, &seq[slot]) == E2PROM_Ok;
+    }
+    if (!valid[0] && !valid[1]) {
+        return E2PROM_Error;
+    }
+    if (valid[0] && valid[1]) {
+        slot = (int16_t)(seq[1] - seq[0]) > 0 ? 1 : 0;
+    } else {
+        slot = valid[1];
+    }
+    result = E2PROM_readBlocking(eeprom, eeprom->WearAddress + slot * E2PROM_wearSlotSize(eeprom), (uint8_t*)eeprom->WearMap,
+                                 E2PROM_wearPages(eeprom) * sizeof(E2PROM_WearCounter));
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    eeprom->WearSeq        = seq[slot];
+    eeprom->WearPending    = 0;
+    eeprom->WearSaveOffset = 0;
+    return E2PROM_Ok;
+}
+
+/**
+ * @brief persist WearMap into older slot of reserved region, NonBlocking
+ *        map is queued page by page across calls and its sequence and crc last, slot is valid only when trailer is written
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return E2PROM_Result E2PROM_Busy if E2PROM can not take rest of map now, next call continues the save
+ */
+E2PROM_Result E2PROM_wearSave(E2PROM* eeprom) {
+    uint16_t      len  = E2PROM_wearPages(eeprom) * sizeof(E2PROM_WearCounter);
+    uint16_t      addr = eeprom->WearAddress + ((eeprom->WearSeq + 1) & 1) * E2PROM_wearSlotSize(eeprom);
+    uint16_t      trailer[2]; /**< sequence and crc */
+    uint16_t      part;
+    E2PROM_Result result;
+    if (eeprom->WearSaveOffset == 0) {
+        eeprom->WearSaveCrc = E2PROM_CRC_INIT;
+    }
+    while (eeprom->WearSaveOffset < len) {
+        part = eeprom->Config->PageSize - (addr + eeprom->WearSaveOffset) % eeprom->Config->PageSize;
+        if (part > len - eeprom->WearSaveOffset) {
+            part = len - eeprom->WearSaveOffset;
+        }
+        result = E2PROM_write(eeprom, addr + eeprom->WearSaveOffset, (uint8_t*)eeprom->WearMap + eeprom->WearSaveOffset, part, E2PROM_Variable);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+        // crc of bytes as they are queued, counters may grow before next page is queued
+        eeprom->WearSaveCrc     = E2PROMCrc_update(eeprom->WearSaveCrc, (const uint8_t*)eeprom->WearMap + eeprom->WearSaveOffset, part);
+        eeprom->WearSaveOffset += part;
+    }
+    trailer[0] = eeprom->WearSeq + 1;
+    trailer[1] = E2PROMCrc_update(eeprom->WearSaveCrc, (const uint8_t*)&trailer[0], sizeof(trailer[0]));
+    result     = E2PROM_write(eeprom, addr + len, (uint8_t*)trailer, sizeof(trailer), E2PROM_Variable);
+    if (result == E2PROM_Ok) {
+        eeprom->WearSeq        = trailer[0];
+        eeprom->WearPending    = 0;
+        eeprom->WearSaveOffset = 0;
+    }
+    return result;
+}
+
+/**
+ * @brief program cycles of a page
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param page   page index
+ * @return E2PROM_WearCounter
+ */
+E2PROM_WearCounter E2PROM_wearCount(E2PROM* eeprom, uint16_t page) {
+    return page < E2PROM_wearPages(eeprom) ? eeprom->WearMap[page] : 0;
+}
+
+/**
+ * @brief find the most programmed pages
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @param pages  buffer for page indexes, hottest first
+ * @param len    Length of pages buffer
+ * @return uint16_t number of page indexes in buffer
+ */
+uint16_t E2PROM_wearHottest(E2PROM* eeprom, uint16_t* pages, uint16_t len) {
+    uint16_t found = 0;
+    uint16_t pos;
+    for (uint16_t page = 0; page < E2PROM_wearPages(eeprom); page++) {
+        pos = found < len ? found++ : len;
+        while (pos > 0 && eeprom->WearMap[pages[pos - 1]] < eeprom->WearMap[page]) {
+            if (pos < len) {
+                pages[pos] = pages[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < len) {
+            pages[pos] = page;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief program cycles left on the hottest page before E2PROM_WEAR_ENDURANCE
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return uint32_t
+ */
+uint32_t E2PROM_wearRemaining(E2PROM* eeprom) {
+    uint16_t hottest;
+    if (E2PROM_wearHottest(eeprom, &hottest, 1) == 0 || eeprom->WearMap[hottest] >= E2PROM_WEAR_ENDURANCE) {
+        return 0;
+    }
+    return E2PROM_WEAR_ENDURANCE - eeprom->WearMap[hottest];
+}
+
+/**
+ * @brief projected time until hottest page reach E2PROM_WEAR_ENDURANCE
+ *        program rate of this session is shared between pages like the lifetime counters
+ *
+ * @param eeprom Address of E2PROM Struct
+ * @return E2PROM_Timestamp return 0xFFFFFFFF if there is no program in this session
+ */
+E2PROM_Timestamp E2PROM_wearProjectedLife(E2PROM* eeprom) {
+    uint64_t total = 0;
+    uint64_t life;
+    uint16_t hottest;
+    for (uint16_t page = 0; page < E2PROM_wearPages(eeprom); page++) {
+        total += eeprom->WearMap[page];
+    }
+    if (eeprom->WearSession == 0 || E2PROM_wearHottest(eeprom, &hottest, 1) == 0 || eeprom->WearMap[hottest] == 0) {
+        return 0xFFFFFFFF;
+    }
+    // remaining * elapsed / (session programs * share of hottest page)
+    life = (uint64_t)E2PROM_wearRemaining(eeprom) * (eepromDriver->getTimestamp() - eeprom->WearStartTime) * total /
+           ((uint64_t)eeprom->WearSession * eeprom->WearMap[hottest]);
+    return life > 0xFFFFFFFF ? 0xFFFFFFFF : (E2PROM_Timestamp)life;
+}
+#endif
+
+
+
+#if E2PROM_TRACE
+/**
+ * @brief start trace recorder, all driver calls and IRQs of all E2PROMs recorded in buffer
+ *
+ * @param buffer       ring buffer for records
+ * @param len          number of records in buffer
+ * @param getTimestamp timestamp of records, NULL for use driver getTimestamp, use a fine timer for bus utilisation
+ */
+void E2PROM_traceInit(E2PROM_TraceRecord* buffer, uint16_t len, E2PROM_getTimestampFn getTimestamp) {
+    E2PROM_TRACE_ENTER_CRITICAL();
+    // tickets of records in flight must not be valid in new buffer
+    traceTaken       += (uint32_t)traceSize + len;
+    traceSize         = len;
+    traceHead         = 0;
+    traceCount        = 0;
+    traceGetTimestamp = getTimestamp != NULL ? getTimestamp : eepromDriver->getTimestamp;
+    traceBuffer       = buffer;
+    E2PROM_TRACE_EXIT_CRITICAL();
+}
+
+/**
+ * @brief stop trace recorder
+ */
+void E2PROM_traceStop(void) {
+    traceBuffer = (E2PROM_TraceRecord*)0;
+}
+
+/**
+ * @brief number of records in trace buffer
+ *
+ * @return uint16_t
+ */
+uint16_t E2PROM_traceAvailable(void) {
+    return traceCount;
+}
+
+/**
+ * @brief send file header and all records, oldest first, to host. the output is input of E2PROMTraceDecoder
+ *        stop trace before dump if u want a steady snapshot
+ *
+ * @param buffer the trace buffer given to E2PROM_traceInit
+ * @param write  function for send bytes, e.g. UART transmit
+ */
+void E2PROM_traceDump(const E2PROM_TraceRecord* buffer, E2PROM_TraceWriteFn write) {
+    E2PROM_TraceFileHeader header;
+    uint16_t               index = traceCount < traceSize ? 0 : traceHead;
+    header.Magic[0]   = 'E';
+    header.Magic[1]   = '2';
+    header.Magic[2]   = 'T';
+    header.Magic[3]   = 'R';
+    header.Version    = E2PROM_TRACE_VERSION;
+    header.RecordSize = sizeof(E2PROM_TraceRecord);
+    header.Count      = traceCount;
+    write((const uint8_t*)&header, sizeof(header));
+    for (uint16_t i = 0; i < header.Count; i++) {
+        write((const uint8_t*)&buffer[index], sizeof(E2PROM_TraceRecord));
+        index = (index + 1) % traceSize;
+    }
+}
+
+/**
+ * @brief remove all records
+ */
+void E2PROM_traceClear(void) {
+    E2PROM_TRACE_ENTER_CRITICAL();
+    traceTaken += traceSize;
+    traceHead   = 0;
+    traceCount  = 0;
+    E2PROM_TRACE_EXIT_CRITICAL();
+}
+#endif
+
+
+
+/**
+ * @brief this Function use for compare 2 Array user can test the write and Read,  
+ * 
+ * @param arr1 Address of Array1
+ * @param arr2 Address of Array2
+ * @param len  Length user want to compare between the Array1 & Array2 
+ * @return int8_t / return 0 if the two Array is Equal
+ */
+int8_t E2PROM_assertMemory (uint8_t* arr1, uint8_t* arr2, uint16_t len) {
+  int result = memcmp (arr1, arr2, len);
+  // int8_t can not hold every result of memcmp
+  return result < 0 ? -1 : (result > 0 ? 1 : 0);
+}
+
+/************************************************ Write/Read NonBlocking *****************************************************/
+E2PROM_Result E2PROM_writeUInt8 (E2PROM* eeprom, uint8_t val, uint16_t addr) {
+    return E2PROM_write (eeprom, addr, (uint8_t*)&val, sizeof(val), E2PROM_Variable);
+}
+E2PROM_Result E2PROM_readUInt8 (E2PROM* eeprom, uint16_t addr) {
+    return E2PROM_read (eeprom, addr, sizeof(uint8_t));
+}
+
+
+E2PROM_Result E2PROM_writeUInt16 (E2PROM* eeprom, uint16_t val, uint16_t addr) {
+    return E2PROM_write (eeprom, addr, (uint8_t*)&val, sizeof(val), E2PROM_Variable);
+}
+E2PROM_Result E2PROM_readUInt16 (E2PROM* eeprom, uint16_t addr) {
+    return E2PROM_read (eeprom, addr, sizeof(uint16_t));
+}
+
+
+E2PROM_Result E2PROM_writeUInt32 (E2PROM* eeprom, uint32_t val, uint16_t addr) {
+    return E2PROM_write (eeprom, addr, (uint8_t*)&val, sizeof(val), E2PROM_Variable);
+}
+E2PROM_Result E2PROM_readUInt32 (E2PROM* eeprom, uint16_t addr) {
+    return E2PROM_read (eeprom, addr, sizeof(uint32_t));
+}
+
+
+
+E2PROM_Result E2PROM_writeUInt64 (E2PROM* eeprom, uint64_t val, uint16_t addr) {
+    return E2PROM_write (eeprom, addr, (uint8_t*)&val, sizeof(val), E2PROM_Variable);
+}
+
+E2PROM_Result E2PROM_readUInt64 (E2PROM* eeprom, uint16_t addr) {
+    return E2PROM_read (eeprom, addr, sizeof(uint64_t));
+}
+
+/************************************************** Write/Read Blocking *********************************************************/
+
+E2PROM_Result E2PROM_writeUInt8Blocking (E2PROM* eeprom, uint8_t val, uint16_t addr) {
+    return E2PROM_writeBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
+}
+uint8_t E2PROM_readUInt8Blocking (E2PROM* eeprom, uint16_t addr) {
+    uint8_t val = 0;
+    E2PROM_readBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
+    return val;
+}
+
+
+E2PROM_Result E2PROM_writeUInt16Blocking (E2PROM* eeprom, uint16_t val, uint16_t addr) {
+    return E2PROM_writeBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
+}
+uint16_t E2PROM_readUInt16Blocking (E2PROM* eeprom, uint16_t addr) {
+    uint16_t val = 0;
+    E2PROM_readBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
+    return val;
+}
+
+
+E2PROM_Result E2PROM_writeUInt32Blocking (E2PROM* eeprom, uint32_t val, uint16_t addr) {
+    return E2PROM_writeBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
+}
+
+uint32_t E2PROM_readUInt32Blocking (E2PROM* eeprom, uint16_t addr) {
+    uint32_t val = 0;
+    E2PROM_readBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
+    return val;
+}
+
+
+E2PROM_Result E2PROM_writeUInt64Blocking (E2PROM* eeprom, uint64_t val, uint16_t addr) {
+    return E2PROM_writeBlocking(eeprom, addr, (uint8_t*)&val, sizeof(val));
+}
+uint64_t E2PROM_readUInt64Blocking (E2PROM* eeprom, uint16_t addr) {
+    uint64_t val = 0;
+    E2PROM_readBlocking (eeprom, addr, (uint8_t*)&val, sizeof(val));
+    return val;
+}
+/***********************************************************************************************************/
+
+
+/**
+ * @brief if the handle process not complete with this Function u can wait As much as this timeout 
+ * 
+ * @param timeout 
+ * @return E2PROM_Result 
+ */
+E2PROM_Result E2PROM_waitForFinishProcess (E2PROM_Timestamp timeout) {    
+     E2PROM_Timestamp time = eepromDriver->getTimestamp() + timeout;
+    while ( E2PROM_handle()) {
+        if (!__deadlineBefore(eepromDriver->getTimestamp(), time)) {
+            return E2PROM_TimeOutError;
+        }
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief wait until processes finish and write cycle of last programmed page of device is over,
+ *        device answers to reads again after this
+ * 
+ * @param eeprom  Address of E2PROM Struct
+ * @param timeout 
+ * @return E2PROM_Result E2PROM_TimeOutError if device is still busy after timeout
+ */
+E2PROM_Result E2PROM_waitWriteCycle (E2PROM* eeprom, E2PROM_Timestamp timeout) {
+    E2PROM_Timestamp time = eepromDriver->getTimestamp() + timeout;
+    while (E2PROM_handle() || !__deadlineBefore(eeprom->NextTick, eepromDriver->getTimestamp())) {
+        if (!__deadlineBefore(eepromDriver->getTimestamp(), time)) {
+            return E2PROM_TimeOutError;
+        }
+    }
+    return E2PROM_Ok;
+}
+
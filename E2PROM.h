@@ -1,294 +1,585 @@
-/** In the Nama of God */
-/**
- * @file E2PROM.h
- * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
- * @brief 
- * @version 0.1
- * @date 2023-09-22
- * 
- * @copyright Copyright (c) 2023
- * 
- */
-
-
-
-#ifndef _E2PROM_H_
-#define _E2PROM_H_
-
-#ifdef _cplusplus
-extern "C" {
-#endif
-
-#include <stdint.h>
-
-#include "Queue.h"
-#include "StreamBuffer.h"
-
-/*************************************************Configuration***********************************************************/
-
-/**
- * @brief E2PROM Default Value use for Erase the E2PROM Chip
- */
-#define E2PROM_DEFAULT_VALUE            0XFF
-
-/**
- * @brief Enable NoiseErase Capability
- */
-#define E2PROM_NOISE_ERASE_NON_BLOCKING 1
-
-/**
- * @brief if u want use Enable capability 
- */
-#define E2PROM_CHECK_ENABLE             0
-
-
-#define E2PROM_USE_INTERRUPT_I2C        0
-/**
- * @brief 
- */
-typedef uint32_t    E2PROM_Timestamp;
-
-
-/**
- * @brief 
- */
-typedef uint16_t    E2PROM_LenType;
-
-/**************************************************************************************************/
-
-
-
-
-/**
- * @brief E2PROM DataType
- */
-typedef enum {
-    E2PROM_Const    = 0x00,
-    E2PROM_Variable = 0x01,
-} E2PROM_DataType;
-
-
-
-/**
- * @brief E2PROM Command Header
- */
-typedef struct {
-    uint32_t MemAddress;
-    uint16_t Len;
-    uint8_t  Mode;
-    uint8_t  Type;
-} E2PROM_CommandHeader;
-
-
-
-/**
- * @brief E2PROM Mode
- */
-typedef enum {
-    E2PROM_ReadMode         = 0x00,
-    E2PROM_WriteMode        = 0x01,
-    E2PROM_EraseMode        = 0x02,
-    E2PROM_NoiseEraseMode   = 0x03,
-} E2PROM_Mode;
-
-
-
-/**
- * @brief
- */
-typedef enum {
-    E2PROM_MemAddrSize8BIT  = (0x00000001U),
-    E2PROM_MemAddrSize16BIT = (0x00000002U),
-    E2PROM_MemAddrSize_Unknown,
-} E2PROM_MemAddrSize;
-
-
-/**
- * @brief config Struct
- */
-typedef struct {
-    void*              HI2C;
-    E2PROM_Timestamp   WriteDelayTime;
-    uint16_t           Size;
-    uint8_t            DeviceId;///0xA0
-    uint8_t            PageSize;
-    E2PROM_MemAddrSize MemAddSize;
-} E2PROM_Config;
-
-
-
-
-/*PreDefined Structure*/
-struct __E2PROM;
-typedef struct __E2PROM E2PROM;
-
-
-
-/**
- * @brief   Result of your Process 
- */
-typedef enum {
-    E2PROM_Ok               = 0,
-    E2PROM_Error            = 1,
-    E2PROM_Busy             = 2,
-    E2PROM_TimeOutError     = 3, 
-    E2PROM_HeaderValueError = 4,
-    E2PROM_Null             = 5,
-} E2PROM_Result;
-
-
-
-/**
- * @brief Callback Function Pointer 
- */
-typedef void (*E2PROM_CallbackFn)(Stream* stream, uint16_t addr, uint16_t len);
-
-
-
-
-typedef union {
-    E2PROM_CallbackFn callbacks[4];
-    struct {
-        E2PROM_CallbackFn onAfterWrite;
-        E2PROM_CallbackFn onRead;
-        E2PROM_CallbackFn onWriteError;
-        E2PROM_CallbackFn onReadError;
-    };
-} E2PROM_Callbacks;
-
-
-
-
-/**
- * @brief E2PROM  main Struct
- */
-struct __E2PROM {
-    struct __E2PROM*     Previous;
-    const E2PROM_Config* Config;
-    E2PROM_Callbacks     Callbacks;  
-    Stream               WriteStream;
-    Stream               ReadStream;
-#if E2PROM_NOISE_ERASE_NON_BLOCKING
-    Stream               NoiseEraseStream;
-#endif
-    Queue                CommandQueue;
-    Queue                ReadQueue;
-    E2PROM_CommandHeader CommandHeaderInProcess;
-    void*                Args; /**< user arguments */
-    E2PROM_Timestamp     NextTick;
-    uint8_t*             ConstVal;
-    uint8_t              TempLen;
-    uint8_t              Lock           : 1;
-    uint8_t              Enabled        : 1;
-    uint8_t              Configured     : 1;
-    uint8_t              EraseExecute   : 1;
-    uint8_t              InBlocking     : 1;
-    uint8_t              InTransmit     : 1;
-    uint8_t              Reserved       : 2;
-};
-
-void E2PROM_onWrite(E2PROM* eeprom, E2PROM_CallbackFn cb);
-void E2PROM_onRead (E2PROM* eeprom, E2PROM_CallbackFn cb);
-void E2PROM_onWriteError(E2PROM* eeprom, E2PROM_CallbackFn cb);
-void E2PROM_onReadError(E2PROM* eeprom, E2PROM_CallbackFn cb);
-/*Function Pointer*/
-
-typedef E2PROM_Result    (*E2PROM_writeFn)(E2PROM* eeprom, uint16_t address, uint8_t* val, uint16_t len);
-typedef E2PROM_Result    (*E2PROM_readFn)(E2PROM* eeprom, uint16_t address, uint8_t* buffer, uint16_t len);
-typedef E2PROM_Timestamp (*E2PROM_getTimestampFn)(void);
-typedef void             (*E2PROM_delayMsFn)(E2PROM_Timestamp time);
-typedef uint32_t         (*E2PROM_getRandomFn)(void);
-
-
-
-
-
-/**
- * @brief E2PROM Driver Struct
- */
-typedef struct {
-    E2PROM_writeFn        write;
-    E2PROM_readFn         read;
-    E2PROM_getTimestampFn getTimestamp;
-    E2PROM_delayMsFn      delayMs;
-    E2PROM_getRandomFn    rand;
-} E2PROM_Driver;
-
-/* Null Define */
-#define NULL_DRIVER (E2PROM_Driver*)0
-#define E2PROM_NULL (E2PROM*)0
-#define NULL        (void*)0
-
-/******************************************************************************************************************/
-
-
-
-void*         E2PROM_getArgs(E2PROM* eeprom);
-void          E2PROM_init(E2PROM* eeprom, uint8_t* commandQBuffer, uint16_t commandQLen, uint8_t* qReadBuffer, uint16_t qReadLen, uint8_t* streamWriteBuffer, uint16_t streamWriteLen, uint8_t* streamReadBuffer, uint16_t streamReadLen);
-void          E2PROM_driverInit(const E2PROM_Driver* driver);
-void          E2PROM_deInit(void); 
-uint8_t       E2PROM_handle(void);
-void          E2PROM_setConfig(E2PROM* eeprom, const E2PROM_Config* config);
-void          E2PROM_setEnabled(E2PROM* eeprom, uint8_t enabled);
-void          E2PROM_readIRQ(E2PROM* eeprom);
-void          E2PROM_writeIRQ(E2PROM* eeprom);
-uint8_t       E2PROM_isEnabled(E2PROM* eeprom);
-E2PROM_Result E2PROM_add(E2PROM* eeprom, const E2PROM_Config* config);
-E2PROM_Result E2PROM_remove(E2PROM* remove);
-E2PROM_Result E2PROM_waitForFinishProcess(E2PROM_Timestamp timeout);
-
-
-
-/***************************************************** Erase E2PROM ************************************************************/
-void          E2PROM_eraseBlocking(E2PROM* eeprom);
-void          E2PROM_noiseEraseBlocking(E2PROM* eeprom);
-void          E2PROM_erase(E2PROM* eeprom);
-
-#if E2PROM_NOISE_ERASE_NON_BLOCKING
-void          E2PROM_noiseEraseInit(E2PROM* eeprom, uint8_t* streamBuffer, uint8_t len);
-void          E2PROM_noiseErase(E2PROM* eeprom);
-#endif
-
-
-/************************************************** Write/Read Blocking *********************************************************/
-E2PROM_Result  E2PROM_writeBlocking(E2PROM* eeprom, uint16_t addr, void* data, uint16_t len);
-E2PROM_Result  E2PROM_readBlocking(E2PROM* eeprom, uint16_t addr, uint8_t* val, uint16_t len);
-
-E2PROM_Result  E2PROM_writeUInt8Blocking(E2PROM* eeprom, uint8_t val, uint16_t addr);
-uint8_t        E2PROM_readUInt8Blocking(E2PROM* eeprom, uint16_t addr);
-
-E2PROM_Result  E2PROM_writeUInt16Blocking(E2PROM* eeprom, uint16_t val, uint16_t addr);
-uint16_t       E2PROM_readUInt16Blocking(E2PROM* eeprom, uint16_t addr);
-
-E2PROM_Result  E2PROM_writeUInt32Blocking(E2PROM* eeprom, uint32_t val, uint16_t addr);
-uint32_t       E2PROM_readUInt32Blocking(E2PROM* eeprom, uint16_t addr);
-
-E2PROM_Result  E2PROM_writeUInt64Blocking(E2PROM* eeprom, uint64_t val, uint16_t addr);
-uint64_t       E2PROM_readUInt64Blocking(E2PROM* eeprom, uint16_t addr);
-
-/************************************************** Write/Read NonBlocking *********************************************************/
-E2PROM_Result  E2PROM_write(E2PROM* eeprom, uint16_t addr, uint8_t* data, uint16_t len, E2PROM_DataType type);
-E2PROM_Result  E2PROM_read(E2PROM* eeprom, uint16_t addr, uint8_t len);
-
-E2PROM_Result  E2PROM_writeUInt8(E2PROM* eeprom, uint8_t val, uint16_t addr);
-void           E2PROM_readUInt8(E2PROM* eeprom, uint16_t addr);
-
-E2PROM_Result  E2PROM_writeUInt16(E2PROM* eeprom, uint16_t val, uint16_t addr);
-void           E2PROM_readUInt16(E2PROM* eeprom, uint16_t addr);
-
-E2PROM_Result  E2PROM_writeUInt32(E2PROM* eeprom, uint32_t val, uint16_t addr);
-void           E2PROM_readUInt32(E2PROM* eeprom, uint16_t addr);
-
-E2PROM_Result  E2PROM_writeUInt64(E2PROM* eeprom, uint64_t val, uint16_t addr);
-void           E2PROM_readUInt64(E2PROM* eeprom, uint16_t addr);
-
-/**********************************************************************************************************************************/
-int8_t E2PROM_assertMemory (uint8_t* arr1, uint8_t* arr2, uint16_t len);
-
-/*********************************************************************************************************************************/
-
-#ifdef _cplusplus
-};
-#endif  // cplusplus
-
-#endif  // _E2PROM_H_
+/** In the Nama of God */
+/**
+ * @file E2PROM.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief 
+ * @version 0.1
+ * @date 2023-09-22
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+
+
+#ifndef _E2PROM_H_
+#define _E2PROM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "Queue.h"
+#include "StreamBuffer.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief E2PROM Default Value use for Erase the E2PROM Chip
+ */
+#define E2PROM_DEFAULT_VALUE            0XFF
+
+/**
+ * @brief Enable NoiseErase Capability
+ */
+#define E2PROM_NOISE_ERASE_NON_BLOCKING 1
+
+/**
+ * @brief if u want use Enable capability 
+ */
+#define E2PROM_CHECK_ENABLE             0
+
+
+#define E2PROM_USE_INTERRUPT_I2C        0
+
+/**
+ * @brief max time blocking functions wait in driver wait for IRQ of each transfer
+ */
+#define E2PROM_BLOCKING_TIMEOUT         100
+
+/**
+ * @brief Enable per page program counters
+ */
+#define E2PROM_WEAR_TRACKING            0
+
+/**
+ * @brief rated program cycles of each page, use for projected endurance
+ */
+#define E2PROM_WEAR_ENDURANCE           1000000UL
+
+/**
+ * @brief Enable trace recorder of driver calls and IRQs
+ */
+#define E2PROM_TRACE                    0
+
+/**
+ * @brief critical section of trace recorder, records are taken from IRQs too so it must mask IRQs of E2PROM,
+ *        e.g. __disable_irq() and __enable_irq(), empty only if IRQs never call E2PROM_writeIRQ and E2PROM_readIRQ
+ */
+#define E2PROM_TRACE_ENTER_CRITICAL()
+#define E2PROM_TRACE_EXIT_CRITICAL()
+
+/**
+ * @brief Enable shared pool for queues and streams, devices borrow blocks on demand
+ */
+#define E2PROM_USE_POOL                 0
+
+/**
+ * @brief size of each block of pool, a queue use one block
+ */
+#define E2PROM_POOL_BLOCK_SIZE          64
+
+/**
+ * @brief max number of blocks in pool, can not be more than 32
+ */
+#define E2PROM_POOL_MAX_BLOCKS          32
+
+/**
+ * @brief blocks borrowed for a WriteStream at least, quota of device permitting,
+ *        a WriteStream can not grow while it hold data, so a bigger one let next writes queue behind the first
+ */
+#define E2PROM_POOL_WRITE_BLOCKS        4
+
+/**
+ * @brief Enable onReadBatch, completed reads of a handle pass are given in one callback
+ */
+#define E2PROM_READ_BATCH               0
+
+/**
+ * @brief max completed reads in one onReadBatch call
+ */
+#define E2PROM_READ_BATCH_SIZE          8
+
+/**
+ * @brief Enable read back of every programmed page before next page is programmed
+ */
+#define E2PROM_WRITE_VERIFY             0
+
+/**
+ * @brief number of times a page that fails verify is programmed again before onWriteError
+ */
+#define E2PROM_VERIFY_RETRIES           2
+
+/**
+ * @brief read back buffer of each device, pages bigger than this are verified in parts
+ */
+#define E2PROM_VERIFY_BUFFER_SIZE       32
+
+/**
+ * @brief Enable requests with deadline, they are done before other commands, earliest deadline first
+ */
+#define E2PROM_USE_DEADLINE             0
+
+/**
+ * @brief max requests with deadline of each device at same time
+ */
+#define E2PROM_DEADLINE_SLOTS           4
+
+/**
+ * @brief Enable staging buffer of Variable writes, each page is copied from WriteStream to it,
+ *        so a write that wraps WriteStream is not split to smaller page programs
+ */
+#define E2PROM_USE_STAGING              0
+
+/**
+ * @brief size of staging buffer, must be >= PageSize of devices (E2PROM_add refuses a bigger page) and multiple of E2PROM_STAGING_ALIGN
+ */
+#define E2PROM_STAGING_SIZE             64
+
+/**
+ * @brief alignment of staging buffer, set it to cache line of your DMA
+ */
+#define E2PROM_STAGING_ALIGN            32
+#define E2PROM_STAGING_ATTR             __attribute__((aligned(E2PROM_STAGING_ALIGN)))
+
+#if E2PROM_USE_STAGING && (E2PROM_STAGING_SIZE % E2PROM_STAGING_ALIGN) != 0
+    #error "E2PROM_STAGING_SIZE must be multiple of E2PROM_STAGING_ALIGN"
+#endif
+
+/**
+ * @brief 
+ */
+typedef uint32_t    E2PROM_Timestamp;
+
+
+/**
+ * @brief 
+ */
+typedef uint16_t    E2PROM_LenType;
+
+/**
+ * @brief program counter of a page
+ */
+typedef uint32_t    E2PROM_WearCounter;
+
+/**************************************************************************************************/
+
+
+
+
+/**
+ * @brief E2PROM DataType
+ */
+typedef enum {
+    E2PROM_Const    = 0x00,
+    E2PROM_Variable = 0x01,
+} E2PROM_DataType;
+
+
+
+/**
+ * @brief E2PROM Command Header
+ */
+typedef struct {
+    uint32_t MemAddress;
+    uint16_t Len;
+    uint8_t  Mode;
+    uint8_t  Type;
+#if E2PROM_USE_DEADLINE
+    E2PROM_Timestamp Deadline;    /**< valid only if HasDeadline */
+    uint8_t          HasDeadline;
+#endif
+} E2PROM_CommandHeader;
+
+
+
+/**
+ * @brief E2PROM Mode
+ */
+typedef enum {
+    E2PROM_ReadMode         = 0x00,
+    E2PROM_WriteMode        = 0x01,
+    E2PROM_EraseMode        = 0x02,
+    E2PROM_NoiseEraseMode   = 0x03,
+} E2PROM_Mode;
+
+
+
+#if E2PROM_USE_POOL
+/**
+ * @brief buffers of device that can be borrowed from pool
+ */
+typedef enum {
+    E2PROM_PoolCommandQueue = 0x00,
+    E2PROM_PoolReadQueue    = 0x01,
+    E2PROM_PoolWriteStream  = 0x02,
+    E2PROM_PoolReadStream   = 0x03,
+    E2PROM_PoolBuffers      = 0x04,
+} E2PROM_PoolBuffer;
+#endif
+
+
+
+/**
+ * @brief
+ */
+typedef enum {
+    E2PROM_MemAddrSize8BIT  = (0x00000001U),
+    E2PROM_MemAddrSize16BIT = (0x00000002U),
+    E2PROM_MemAddrSize_Unknown,
+} E2PROM_MemAddrSize;
+
+
+/**
+ * @brief config Struct
+ */
+typedef struct {
+    void*              HI2C;
+    E2PROM_Timestamp   WriteDelayTime;
+    uint16_t           Size;
+    uint8_t            DeviceId;///0xA0
+    uint8_t            PageSize;
+    E2PROM_MemAddrSize MemAddSize;
+} E2PROM_Config;
+
+
+
+
+/*PreDefined Structure*/
+struct __E2PROM;
+typedef struct __E2PROM E2PROM;
+
+
+
+/**
+ * @brief   Result of your Process 
+ */
+typedef enum {
+    E2PROM_Ok               = 0,
+    E2PROM_Error            = 1,
+    E2PROM_Busy             = 2,
+    E2PROM_TimeOutError     = 3, 
+    E2PROM_HeaderValueError = 4,
+    E2PROM_Null             = 5,
+} E2PROM_Result;
+
+
+
+/**
+ * @brief Callback Function Pointer 
+ */
+typedef void (*E2PROM_CallbackFn)(Stream* stream, uint16_t addr, uint16_t len);
+
+#if E2PROM_READ_BATCH
+/**
+ * @brief Batch Callback, data of reads are in stream one after another in order of reads
+ */
+typedef void (*E2PROM_ReadBatchFn)(Stream* stream, const E2PROM_CommandHeader* reads, uint8_t count);
+#endif
+
+#if E2PROM_USE_DEADLINE
+/**
+ * @brief Deadline Callback, result is E2PROM_Ok for a request done in time and E2PROM_TimeOutError when deadline is passed
+ */
+typedef void (*E2PROM_DeadlineFn)(E2PROM* eeprom, const E2PROM_CommandHeader* request, E2PROM_Result result);
+#endif
+
+
+
+
+typedef union {
+    E2PROM_CallbackFn callbacks[4];
+    struct {
+        E2PROM_CallbackFn onAfterWrite;
+        E2PROM_CallbackFn onRead;
+        E2PROM_CallbackFn onWriteError;
+        E2PROM_CallbackFn onReadError;
+    };
+} E2PROM_Callbacks;
+
+
+
+
+/**
+ * @brief E2PROM  main Struct
+ */
+struct __E2PROM {
+    struct __E2PROM*     Previous;
+    const E2PROM_Config* Config;
+    E2PROM_Callbacks     Callbacks;  
+#if E2PROM_READ_BATCH
+    E2PROM_ReadBatchFn   onReadBatch;
+#endif
+#if E2PROM_USE_DEADLINE
+    E2PROM_CommandHeader Urgent[E2PROM_DEADLINE_SLOTS];     /**< requests with deadline, Len 0 is a free slot */
+    uint8_t*             UrgentData[E2PROM_DEADLINE_SLOTS]; /**< data of write requests */
+    E2PROM_CommandHeader Suspended;     /**< command paused for a request with deadline, Len 0 if none */
+    uint8_t*             SuspendedConstVal;
+    E2PROM_DeadlineFn    onDeadline;
+    uint8_t              UrgentMissed;  /**< bit of each slot that its deadline is reported as missed */
+    uint8_t              UrgentSlot;    /**< slot in process */
+    uint8_t              InUrgent;      /**< CommandHeaderInProcess is the request of UrgentSlot */
+#endif
+#if E2PROM_USE_STAGING
+    uint8_t              Staging[E2PROM_STAGING_SIZE] E2PROM_STAGING_ATTR; /**< page of Variable write in process */
+    uint8_t              Staged;        /**< Staging has page of TempLen, it is programmed again on verify retry */
+#endif
+    Stream               WriteStream;
+    Stream               ReadStream;
+#if E2PROM_NOISE_ERASE_NON_BLOCKING
+    Stream               NoiseEraseStream;
+#endif
+    Queue                CommandQueue;
+    Queue                ReadQueue;
+    E2PROM_CommandHeader CommandHeaderInProcess;
+    void*                Args; /**< user arguments */
+    E2PROM_Timestamp     NextTick;
+    uint8_t*             ConstVal;
+#if E2PROM_WEAR_TRACKING
+    E2PROM_WearCounter*  WearMap;       /**< program counter of each page */
+    E2PROM_Timestamp     WearStartTime;
+    uint32_t             WearSession;   /**< page programs since E2PROM_wearInit */
+    uint16_t             WearAddress;   /**< reserved region for persist WearMap */
+    uint16_t             WearPending;   /**< page programs since last persist */
+    uint16_t             WearSeq;       /**< sequence of last persisted slot */
+    uint16_t             WearPeriod;
+    uint16_t             WearSaveOffset; /**< bytes of WearMap queued by a save in progress */
+    uint16_t             WearSaveCrc;    /**< crc of queued bytes of WearMap */
+#endif
+#if E2PROM_USE_POOL
+    uint8_t              PoolFirst[E2PROM_PoolBuffers]; /**< first block of each borrowed buffer */
+    uint8_t              PoolCount[E2PROM_PoolBuffers]; /**< blocks of each borrowed buffer, 0 if not borrowed */
+    uint8_t              PoolQuota;     /**< max blocks device can hold, 0 device use its own buffers */
+#endif
+#if E2PROM_WRITE_VERIFY
+    uint8_t              VerifyBuffer[E2PROM_VERIFY_BUFFER_SIZE];
+    uint8_t              VerifyOffset;  /**< bytes of programmed page verified */
+    uint8_t              VerifyRetries; /**< programs of current page that failed verify */
+    uint8_t              VerifyPending; /**< page is programmed and must be read back */
+    uint8_t              InVerify;      /**< read back is on the bus */
+    uint8_t              VerifyFailed;  /**< a page of write in process failed verify, write ends with onWriteError */
+#if E2PROM_USE_DEADLINE
+    uint8_t              SuspendedVerifyFailed;
+#endif
+#endif
+#if E2PROM_TRACE
+    uint8_t              TraceId;       /**< Device of trace records, in order of E2PROM_add */
+#endif
+    uint8_t              TempLen;
+    uint8_t              Lock           : 1;
+    uint8_t              Enabled        : 1;
+    uint8_t              Configured     : 1;
+    uint8_t              EraseExecute   : 1;
+    uint8_t              InBlocking     : 1;
+    uint8_t              InTransmit     : 1;
+    uint8_t              Reserved       : 2;
+};
+
+void E2PROM_onWrite(E2PROM* eeprom, E2PROM_CallbackFn cb);
+void E2PROM_onRead (E2PROM* eeprom, E2PROM_CallbackFn cb);
+void E2PROM_onWriteError(E2PROM* eeprom, E2PROM_CallbackFn cb);
+void E2PROM_onReadError(E2PROM* eeprom, E2PROM_CallbackFn cb);
+#if E2PROM_USE_DEADLINE
+void E2PROM_onDeadline(E2PROM* eeprom, E2PROM_DeadlineFn cb);
+#endif
+#if E2PROM_READ_BATCH
+void E2PROM_onReadBatch(E2PROM* eeprom, E2PROM_ReadBatchFn cb);
+#endif
+/*Function Pointer*/
+
+typedef E2PROM_Result    (*E2PROM_writeFn)(E2PROM* eeprom, uint16_t address, uint8_t* val, uint16_t len);
+typedef E2PROM_Result    (*E2PROM_readFn)(E2PROM* eeprom, uint16_t address, uint8_t* buffer, uint16_t len);
+typedef E2PROM_Timestamp (*E2PROM_getTimestampFn)(void);
+typedef void             (*E2PROM_delayMsFn)(E2PROM_Timestamp time);
+typedef uint32_t         (*E2PROM_getRandomFn)(void);
+typedef E2PROM_Result    (*E2PROM_waitFn)(E2PROM* eeprom, E2PROM_Timestamp timeout);
+typedef void             (*E2PROM_signalFn)(E2PROM* eeprom);
+
+
+
+
+
+/**
+ * @brief E2PROM Driver Struct
+ *
+ * wait and signal are optional (NULL for busy wait), with E2PROM_USE_INTERRUPT_I2C blocking functions sleep in wait
+ * until IRQ of transfer call signal, like an RTOS binary semaphore, a signal before wait must not be lost,
+ * wait can return E2PROM_Ok before signal, E2PROM_TimeOutError stops the blocking function,
+ * delayMs between pages of blocking functions can be an RTOS delay too
+ */
+typedef struct {
+    E2PROM_writeFn        write;
+    E2PROM_readFn         read;
+    E2PROM_getTimestampFn getTimestamp;
+    E2PROM_delayMsFn      delayMs;
+    E2PROM_getRandomFn    rand;
+    E2PROM_waitFn         wait;
+    E2PROM_signalFn       signal;
+} E2PROM_Driver;
+
+#if E2PROM_TRACE
+/**
+ * @brief Trace Event
+ */
+typedef enum {
+    E2PROM_TraceWrite       = 0x00, /**< driver write called */
+    E2PROM_TraceRead        = 0x01, /**< driver read called */
+    E2PROM_TraceWriteIRQ    = 0x02, /**< E2PROM_writeIRQ */
+    E2PROM_TraceReadIRQ     = 0x03, /**< E2PROM_readIRQ */
+    E2PROM_TraceBlocking    = 0x80, /**< flag, event of a blocking function */
+} E2PROM_TraceEvent;
+
+
+
+/**
+ * @brief Trace Record, 12 bytes little endian
+ *        Address and Len of IRQ events of blocking functions are 0
+ */
+typedef struct {
+    E2PROM_Timestamp Timestamp;
+    uint16_t         Address;
+    uint16_t         Len;
+    uint8_t          Device;
+    uint8_t          Mode;
+    uint8_t          Event;
+    uint8_t          Result;
+} E2PROM_TraceRecord;
+
+
+
+/**
+ * @brief header of trace dump, followed by Count records
+ */
+typedef struct {
+    char     Magic[4];  /**< "E2TR" */
+    uint8_t  Version;
+    uint8_t  RecordSize;
+    uint16_t Count;
+} E2PROM_TraceFileHeader;
+
+#define E2PROM_TRACE_VERSION            1
+
+typedef void (*E2PROM_TraceWriteFn)(const uint8_t* data, uint16_t len);
+#endif
+
+/* Null Define */
+#define NULL_DRIVER (E2PROM_Driver*)0
+#define E2PROM_NULL (E2PROM*)0
+#ifndef NULL
+#define NULL        (void*)0
+#endif
+
+/******************************************************************************************************************/
+
+
+
+void*         E2PROM_getArgs(E2PROM* eeprom);
+void          E2PROM_init(E2PROM* eeprom, uint8_t* commandQBuffer, uint16_t commandQLen, uint8_t* qReadBuffer, uint16_t qReadLen, uint8_t* streamWriteBuffer, uint16_t streamWriteLen, uint8_t* streamReadBuffer, uint16_t streamReadLen);
+void          E2PROM_driverInit(const E2PROM_Driver* driver);
+void          E2PROM_deInit(void); 
+uint8_t       E2PROM_handle(void);
+void          E2PROM_setConfig(E2PROM* eeprom, const E2PROM_Config* config);
+void          E2PROM_setEnabled(E2PROM* eeprom, uint8_t enabled);
+void          E2PROM_readIRQ(E2PROM* eeprom);
+void          E2PROM_writeIRQ(E2PROM* eeprom);
+uint8_t       E2PROM_isEnabled(E2PROM* eeprom);
+E2PROM_Result E2PROM_add(E2PROM* eeprom, const E2PROM_Config* config);
+E2PROM_Result E2PROM_remove(E2PROM* remove);
+E2PROM_Result E2PROM_waitForFinishProcess(E2PROM_Timestamp timeout);
+E2PROM_Result E2PROM_waitWriteCycle(E2PROM* eeprom, E2PROM_Timestamp timeout);
+
+
+
+/***************************************************** Erase E2PROM ************************************************************/
+E2PROM_Result E2PROM_eraseBlocking(E2PROM* eeprom);
+E2PROM_Result E2PROM_noiseEraseBlocking(E2PROM* eeprom);
+E2PROM_Result E2PROM_erase(E2PROM* eeprom);
+
+#if E2PROM_NOISE_ERASE_NON_BLOCKING
+void          E2PROM_noiseEraseInit(E2PROM* eeprom, uint8_t* streamBuffer, uint8_t len);
+E2PROM_Result E2PROM_noiseErase(E2PROM* eeprom);
+#endif
+
+
+/************************************************** Write/Read Blocking *********************************************************/
+E2PROM_Result  E2PROM_writeBlocking(E2PROM* eeprom, uint16_t addr, void* data, uint16_t len);
+E2PROM_Result  E2PROM_readBlocking(E2PROM* eeprom, uint16_t addr, uint8_t* val, uint16_t len);
+
+E2PROM_Result  E2PROM_writeUInt8Blocking(E2PROM* eeprom, uint8_t val, uint16_t addr);
+uint8_t        E2PROM_readUInt8Blocking(E2PROM* eeprom, uint16_t addr);
+
+E2PROM_Result  E2PROM_writeUInt16Blocking(E2PROM* eeprom, uint16_t val, uint16_t addr);
+uint16_t       E2PROM_readUInt16Blocking(E2PROM* eeprom, uint16_t addr);
+
+E2PROM_Result  E2PROM_writeUInt32Blocking(E2PROM* eeprom, uint32_t val, uint16_t addr);
+uint32_t       E2PROM_readUInt32Blocking(E2PROM* eeprom, uint16_t addr);
+
+E2PROM_Result  E2PROM_writeUInt64Blocking(E2PROM* eeprom, uint64_t val, uint16_t addr);
+uint64_t       E2PROM_readUInt64Blocking(E2PROM* eeprom, uint16_t addr);
+
+/************************************************** Write/Read NonBlocking *********************************************************/
+E2PROM_Result  E2PROM_write(E2PROM* eeprom, uint16_t addr, uint8_t* data, uint16_t len, E2PROM_DataType type);
+E2PROM_Result  E2PROM_read(E2PROM* eeprom, uint16_t addr, uint8_t len);
+E2PROM_Result  E2PROM_writeWait(E2PROM* eeprom, uint16_t addr, uint8_t* data, uint16_t len, E2PROM_DataType type, E2PROM_Timestamp timeout);
+E2PROM_Result  E2PROM_readWait(E2PROM* eeprom, uint16_t addr, uint8_t len, E2PROM_Timestamp timeout);
+#if E2PROM_USE_DEADLINE
+E2PROM_Result  E2PROM_writeDeadline(E2PROM* eeprom, uint16_t addr, uint8_t* data, uint16_t len, E2PROM_Timestamp within);
+E2PROM_Result  E2PROM_readDeadline(E2PROM* eeprom, uint16_t addr, uint8_t len, E2PROM_Timestamp within);
+#endif
+E2PROM_LenType E2PROM_commandSpace(E2PROM* eeprom);
+E2PROM_LenType E2PROM_writeSpace(E2PROM* eeprom);
+
+E2PROM_Result  E2PROM_writeUInt8(E2PROM* eeprom, uint8_t val, uint16_t addr);
+E2PROM_Result  E2PROM_readUInt8(E2PROM* eeprom, uint16_t addr);
+
+E2PROM_Result  E2PROM_writeUInt16(E2PROM* eeprom, uint16_t val, uint16_t addr);
+E2PROM_Result  E2PROM_readUInt16(E2PROM* eeprom, uint16_t addr);
+
+E2PROM_Result  E2PROM_writeUInt32(E2PROM* eeprom, uint32_t val, uint16_t addr);
+E2PROM_Result  E2PROM_readUInt32(E2PROM* eeprom, uint16_t addr);
+
+E2PROM_Result  E2PROM_writeUInt64(E2PROM* eeprom, uint64_t val, uint16_t addr);
+E2PROM_Result  E2PROM_readUInt64(E2PROM* eeprom, uint16_t addr);
+
+/************************************************** Wear Tracking *********************************************************/
+#if E2PROM_WEAR_TRACKING
+void               E2PROM_wearInit(E2PROM* eeprom, E2PROM_WearCounter* map, uint16_t persistAddress, uint16_t period);
+uint16_t           E2PROM_wearPages(E2PROM* eeprom);
+uint16_t           E2PROM_wearRegionSize(E2PROM* eeprom);
+E2PROM_Result      E2PROM_wearLoad(E2PROM* eeprom);
+E2PROM_Result      E2PROM_wearSave(E2PROM* eeprom);
+E2PROM_WearCounter E2PROM_wearCount(E2PROM* eeprom, uint16_t page);
+uint16_t           E2PROM_wearHottest(E2PROM* eeprom, uint16_t* pages, uint16_t len);
+uint32_t           E2PROM_wearRemaining(E2PROM* eeprom);
+E2PROM_Timestamp   E2PROM_wearProjectedLife(E2PROM* eeprom);
+#endif
+
+/************************************************** Pool *********************************************************/
+#if E2PROM_USE_POOL
+void               E2PROM_poolInit(uint8_t* buffer, uint16_t len);
+void               E2PROM_initPooled(E2PROM* eeprom, uint8_t quota);
+uint8_t            E2PROM_poolFreeBlocks(void);
+uint8_t            E2PROM_poolHeldBlocks(E2PROM* eeprom);
+#endif
+
+/************************************************** Trace *********************************************************/
+#if E2PROM_TRACE
+void               E2PROM_traceInit(E2PROM_TraceRecord* buffer, uint16_t len, E2PROM_getTimestampFn getTimestamp);
+void               E2PROM_traceStop(void);
+uint16_t           E2PROM_traceAvailable(void);
+void               E2PROM_traceDump(const E2PROM_TraceRecord* buffer, E2PROM_TraceWriteFn write);
+void               E2PROM_traceClear(void);
+#endif
+
+/**********************************************************************************************************************************/
+int8_t E2PROM_assertMemory (uint8_t* arr1, uint8_t* arr2, uint16_t len);
+
+/*********************************************************************************************************************************/
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_H_
@@ -0,0 +1,546 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMAsync.hpp
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief C++20 coroutine front-end of E2PROM, co_await write and read of devices driven by an Executor
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * E2PROMAsync::Device       dev(&eeprom);
+ * E2PROMAsync::Executor     executor;
+ *
+ * E2PROMAsync::Task saveConfig(void) {
+ *     E2PROM_Result result = co_await dev.write(0x100, std::span<const uint8_t>(config, sizeof(config)));
+ *     if (result == E2PROM_Ok) {
+ *         result = co_await dev.read(0x100, std::span<uint8_t>(check, sizeof(check)));
+ *     }
+ *     co_return result;
+ * }
+ *
+ * executor.spawn(saveConfig());
+ * executor.run();
+ *
+ * Frames of coroutines come from a static pool, no heap is used.
+ * Executor call E2PROM_handle itself, don't call it anywhere else when Executor is in use,
+ * and all nonBlocking commands of a Device must be given by it (onWrite, onRead, onWriteError, onReadError are taken by Device)
+ */
+
+
+
+#ifndef _E2PROM_ASYNC_HPP_
+#define _E2PROM_ASYNC_HPP_
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+
+#include "E2PROM.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief number of coroutine frames in pool, a Task that co_await another Task use 2 frames
+ */
+#define E2PROMASYNC_MAX_FRAMES          4
+
+/**
+ * @brief max size of frame of a coroutine, bigger coroutines can not start (compiler keep every awaiter and local in it)
+ */
+#define E2PROMASYNC_FRAME_SIZE          512
+
+/**
+ * @brief max bytes of each command, operations split to commands of this size, must fit in WriteStream and ReadStream
+ */
+#define E2PROMASYNC_CHUNK_SIZE          32
+
+/**
+ * @brief max write commands of a Device given to E2PROM and not finished yet, power of 2 up to 32
+ */
+#define E2PROMASYNC_MAX_WRITES          16
+
+/**************************************************************************************************/
+
+namespace E2PROMAsync {
+
+/**
+ * @brief static pool of coroutine frames
+ */
+class FramePool {
+public:
+    static void* alloc(std::size_t size) noexcept {
+        if (size <= E2PROMASYNC_FRAME_SIZE) {
+            for (uint8_t i = 0; i < E2PROMASYNC_MAX_FRAMES; i++) {
+                if ((used & (1UL << i)) == 0) {
+                    used |= 1UL << i;
+                    return frames[i].Data;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    static void release(void* frame) noexcept {
+        used &= ~(1UL << (static_cast<Frame*>(frame) - frames));
+    }
+
+    static uint8_t freeFrames(void) noexcept {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < E2PROMASYNC_MAX_FRAMES; i++) {
+            count += (used & (1UL << i)) == 0;
+        }
+        return count;
+    }
+
+private:
+    struct alignas(std::max_align_t) Frame {
+        unsigned char Data[E2PROMASYNC_FRAME_SIZE];
+    };
+    static_assert(E2PROMASYNC_MAX_FRAMES <= 32, "used is a 32 bit mask");
+
+    static inline Frame    frames[E2PROMASYNC_MAX_FRAMES];
+    static inline uint32_t used = 0;
+};
+
+
+
+/**
+ * @brief coroutine that co_return E2PROM_Result, it starts when spawned on Executor or when it is co_awaited,
+ *        when pool has no frame it is not valid and give E2PROM_Busy
+ */
+class Task {
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    struct FinalAwaiter {
+        bool await_ready(void) const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle handle) noexcept {
+            // go back to Task that co_await this one, Executor free the frame of top Task
+            std::coroutine_handle<> continuation = handle.promise().Continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume(void) const noexcept {}
+    };
+
+    struct promise_type {
+        std::coroutine_handle<> Continuation;
+        E2PROM_Result           Result = E2PROM_Ok;
+
+        static void* operator new(std::size_t size) noexcept { return FramePool::alloc(size); }
+        static void  operator delete(void* frame) noexcept { FramePool::release(frame); }
+        static Task  get_return_object_on_allocation_failure(void) noexcept { return Task(); }
+
+        Task                get_return_object(void) noexcept { return Task(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend(void) const noexcept { return {}; }
+        FinalAwaiter        final_suspend(void) const noexcept { return {}; }
+        void                return_value(E2PROM_Result result) noexcept { Result = result; }
+        void                unhandled_exception(void) noexcept { std::terminate(); }
+    };
+
+    struct Awaiter {
+        Handle Coroutine;
+
+        bool await_ready(void) const noexcept { return !Coroutine; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+            Coroutine.promise().Continuation = caller;
+            return Coroutine;
+        }
+        E2PROM_Result await_resume(void) const noexcept { return Coroutine ? Coroutine.promise().Result : E2PROM_Busy; }
+    };
+
+    Task(void) noexcept = default;
+    Task(Task&& other) noexcept : coroutine(other.coroutine) { other.coroutine = nullptr; }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (coroutine) {
+                coroutine.destroy();
+            }
+            coroutine       = other.coroutine;
+            other.coroutine = nullptr;
+        }
+        return *this;
+    }
+    ~Task() {
+        if (coroutine) {
+            coroutine.destroy();
+        }
+    }
+
+    bool    valid(void) const noexcept { return static_cast<bool>(coroutine); }
+    Awaiter operator co_await() && noexcept { return Awaiter{coroutine}; }
+
+    /**
+     * @brief give the coroutine to Executor
+     */
+    Handle release(void) noexcept {
+        Handle handle = coroutine;
+        coroutine     = nullptr;
+        return handle;
+    }
+
+private:
+    explicit Task(Handle handle) noexcept : coroutine(handle) {}
+
+    Handle coroutine;
+};
+
+
+
+class Device;
+
+/**
+ * @brief a write or read of Device, it is in frame of coroutine that co_await it
+ */
+class Operation {
+public:
+    bool          await_ready(void) const noexcept { return len == 0; }
+    void          await_suspend(std::coroutine_handle<> caller) noexcept;
+    E2PROM_Result await_resume(void) const noexcept { return result; }
+
+private:
+    friend class Device;
+
+    Operation(Device* device, uint8_t mode, uint16_t addr, uint8_t* data, std::size_t len) noexcept :
+        device(device), data(data), addr(addr), len(static_cast<uint16_t>(len)), mode(mode),
+        result(len == 0 || len > 0xFFFF ? E2PROM_HeaderValueError : E2PROM_Ok) {
+        if (result != E2PROM_Ok) {
+            this->len = 0;
+        }
+    }
+
+    Device*                 device;
+    Operation*              next      = nullptr;
+    std::coroutine_handle<> caller;
+    uint8_t*                data;
+    uint16_t                addr;
+    uint16_t                len;
+    uint16_t                submitted = 0; /**< bytes given to E2PROM */
+    uint16_t                done      = 0; /**< bytes E2PROM is finished */
+    uint8_t                 mode;
+    E2PROM_Result           result;
+};
+
+
+
+/**
+ * @brief E2PROM device that its writes and reads can be co_awaited
+ */
+class Device {
+public:
+    explicit Device(E2PROM* eeprom) noexcept : eeprom(eeprom) {
+        previous = last;
+        last     = this;
+        E2PROM_onWrite(eeprom, onWrite);
+        E2PROM_onRead(eeprom, onRead);
+        E2PROM_onWriteError(eeprom, onWriteError);
+        E2PROM_onReadError(eeprom, onReadError);
+    }
+
+    ~Device() {
+        Device** pDevice = &last;
+        while (*pDevice != nullptr && *pDevice != this) {
+            pDevice = &(*pDevice)->previous;
+        }
+        if (*pDevice != nullptr) {
+            *pDevice = previous;
+        }
+    }
+
+    Device(const Device&) = delete;
+    Device& operator=(const Device&) = delete;
+
+    /**
+     * @brief co_await it to write data, data must be valid until co_await return
+     */
+    Operation write(uint16_t addr, std::span<const uint8_t> data) noexcept {
+        return Operation(this, E2PROM_WriteMode, addr, const_cast<uint8_t*>(data.data()), data.size());
+    }
+
+    /**
+     * @brief co_await it to read to buffer
+     */
+    Operation read(uint16_t addr, std::span<uint8_t> buffer) noexcept {
+        return Operation(this, E2PROM_ReadMode, addr, buffer.data(), buffer.size());
+    }
+
+    E2PROM* handle(void) const noexcept { return eeprom; }
+
+    /**
+     * @brief give new commands to E2PROM and resume coroutines of finished operations, for all devices
+     */
+    static void process(void) noexcept {
+        Device* pDevice = last;
+        while (pDevice != nullptr) {
+            pDevice->processDevice();
+            pDevice = pDevice->previous;
+        }
+    }
+
+private:
+    friend class Operation;
+
+    struct List {
+        Operation* Head = nullptr;
+        Operation* Tail = nullptr;
+    };
+
+    void add(Operation* operation) noexcept {
+        List& list = operation->mode == E2PROM_WriteMode ? writes : reads;
+        if (list.Tail != nullptr) {
+            list.Tail->next = operation;
+        } else {
+            list.Head = operation;
+        }
+        list.Tail = operation;
+    }
+
+    /**
+     * @brief first operation that is not finished by E2PROM, completions come in order of commands
+     */
+    static Operation* inProcess(List& list) noexcept {
+        Operation* operation = list.Head;
+        while (operation != nullptr && operation->done == operation->submitted) {
+            operation = operation->next;
+        }
+        return operation;
+    }
+
+    static void finishPart(Operation* operation) noexcept {
+        uint16_t part = operation->submitted - operation->done;
+        operation->done += part > E2PROMASYNC_CHUNK_SIZE ? E2PROMASYNC_CHUNK_SIZE : part;
+    }
+
+    void submit(List& list) noexcept {
+        Operation*    operation = list.Head;
+        E2PROM_Result result;
+        uint16_t      part;
+        while (operation != nullptr) {
+            while (operation->submitted < operation->len) {
+                // result of each write is kept in a bit of writesFailed until it is seen
+                if (operation->mode == E2PROM_WriteMode && static_cast<uint16_t>(writesSubmitted - writesSeen) >= E2PROMASYNC_MAX_WRITES) {
+                    return;
+                }
+                part   = operation->len - operation->submitted;
+                part   = part > E2PROMASYNC_CHUNK_SIZE ? E2PROMASYNC_CHUNK_SIZE : part;
+                result = operation->mode == E2PROM_WriteMode ?
+                         E2PROM_write(eeprom, operation->addr + operation->submitted, operation->data + operation->submitted, part, E2PROM_Variable) :
+                         E2PROM_read(eeprom, operation->addr + operation->submitted, static_cast<uint8_t>(part));
+                if (result == E2PROM_Busy) {
+                    // keep order of commands, try again in next pass
+                    return;
+                }
+                if (result != E2PROM_Ok) {
+                    // finish operation with parts that are given
+                    operation->result = result;
+                    operation->len    = operation->submitted;
+                    break;
+                }
+                operation->submitted += part;
+                if (operation->mode == E2PROM_WriteMode) {
+                    writesSubmitted++;
+                }
+            }
+            operation = operation->next;
+        }
+    }
+
+    void resume(List& list) noexcept {
+        Operation* operation;
+        while (list.Head != nullptr && list.Head->submitted == list.Head->len && list.Head->done == list.Head->len) {
+            operation = list.Head;
+            list.Head = operation->next;
+            if (list.Head == nullptr) {
+                list.Tail = nullptr;
+            }
+            // operation is gone after resume
+            operation->caller.resume();
+        }
+    }
+
+    void processDevice(void) noexcept {
+        Operation* operation;
+        // writes are finished in writeIRQ, here they are given to operations in same order
+        while (writesSeen != writesDone) {
+            operation = inProcess(writes);
+            if (operation != nullptr) {
+                if (writesFailed & (1UL << (writesSeen % E2PROMASYNC_MAX_WRITES))) {
+                    operation->result = E2PROM_Error;
+                }
+                finishPart(operation);
+            }
+            writesSeen++;
+        }
+        resume(writes);
+        resume(reads);
+        submit(writes);
+        submit(reads);
+    }
+
+    /**
+     * @brief onRead get a locked copy of ReadStream, so device is found by buffer of stream
+     */
+    static Device* find(Stream* stream) noexcept {
+        uint8_t* data    = Stream_getDataPtr(stream);
+        Device*  pDevice = last;
+        while (pDevice != nullptr && Stream_getDataPtr(&pDevice->eeprom->WriteStream) != data &&
+               Stream_getDataPtr(&pDevice->eeprom->ReadStream) != data) {
+            pDevice = pDevice->previous;
+        }
+        return pDevice;
+    }
+
+    /**
+     * @brief E2PROM give one completion for each write command, onWrite or onWriteError, in order of commands
+     */
+    void writeFinished(bool failed) noexcept {
+        uint32_t bit = 1UL << (writesDone % E2PROMASYNC_MAX_WRITES);
+        writesFailed = failed ? (writesFailed | bit) : (writesFailed & ~bit);
+        writesDone   = writesDone + 1;
+    }
+
+    static void onWrite(Stream* stream, uint16_t addr, uint16_t len) {
+        Device* device = find(stream);
+        (void)addr;
+        (void)len;
+        if (device != nullptr) {
+            device->writeFinished(false);
+        }
+    }
+
+    static void onWriteError(Stream* stream, uint16_t addr, uint16_t len) {
+        Device* device = find(stream);
+        (void)addr;
+        (void)len;
+        if (device != nullptr) {
+            device->writeFinished(true);
+        }
+    }
+
+    static void onRead(Stream* stream, uint16_t addr, uint16_t len) {
+        Device*    device = find(stream);
+        Operation* operation;
+        (void)addr;
+        if (device != nullptr) {
+            operation = inProcess(device->reads);
+            if (operation != nullptr) {
+                Stream_readBytes(stream, operation->data + operation->done, len);
+                operation->done += len;
+            }
+        }
+    }
+
+    static void onReadError(Stream* stream, uint16_t addr, uint16_t len) {
+        Device*    device = find(stream);
+        Operation* operation;
+        (void)addr;
+        if (device != nullptr) {
+            operation = inProcess(device->reads);
+            if (operation != nullptr) {
+                operation->result = E2PROM_Error;
+                operation->done  += len;
+            }
+        }
+    }
+
+    static inline Device* last = nullptr;
+
+    Device*           previous;
+    E2PROM*           eeprom;
+    List              writes;
+    List              reads;
+    volatile uint16_t writesDone      = 0; /**< counted in writeIRQ, errors too */
+    volatile uint32_t writesFailed    = 0; /**< bit (n % E2PROMASYNC_MAX_WRITES) is set if write n failed */
+    uint16_t          writesSeen      = 0;
+    uint16_t          writesSubmitted = 0;
+};
+
+
+
+inline void Operation::await_suspend(std::coroutine_handle<> caller) noexcept {
+    this->caller = caller;
+    device->add(this);
+}
+
+
+
+/**
+ * @brief run spawned Tasks, each poll is one pass of E2PROM_handle
+ */
+class Executor {
+public:
+    Executor(void) noexcept = default;
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    ~Executor() {
+        for (uint8_t i = 0; i < E2PROMASYNC_MAX_FRAMES; i++) {
+            if (tasks[i]) {
+                tasks[i].destroy();
+            }
+        }
+    }
+
+    /**
+     * @brief Task starts in next poll
+     *
+     * @return E2PROM_Result E2PROM_Null if Task is not valid, E2PROM_Busy if Executor is full
+     */
+    E2PROM_Result spawn(Task&& task) noexcept {
+        if (!task.valid()) {
+            return E2PROM_Null;
+        }
+        for (uint8_t i = 0; i < E2PROMASYNC_MAX_FRAMES; i++) {
+            if (!tasks[i]) {
+                tasks[i]  = task.release();
+                started  &= ~(1UL << i);
+                return E2PROM_Ok;
+            }
+        }
+        return E2PROM_Busy;
+    }
+
+    /**
+     * @brief one pass of E2PROM and Tasks
+     *
+     * @return uint8_t number of Tasks are not finished
+     */
+    uint8_t poll(void) noexcept {
+        uint8_t running = 0;
+        E2PROM_handle();
+        Device::process();
+        for (uint8_t i = 0; i < E2PROMASYNC_MAX_FRAMES; i++) {
+            if (tasks[i] && (started & (1UL << i)) == 0) {
+                started |= 1UL << i;
+                tasks[i].resume();
+            }
+            if (tasks[i] && tasks[i].done()) {
+                tasks[i].destroy();
+                tasks[i] = nullptr;
+            }
+            running += static_cast<bool>(tasks[i]);
+        }
+        return running;
+    }
+
+    /**
+     * @brief poll until all Tasks are finished
+     */
+    void run(void) noexcept {
+        while (poll() > 0) {
+        }
+    }
+
+private:
+    Task::Handle tasks[E2PROMASYNC_MAX_FRAMES];
+    uint32_t     started = 0;
+};
+
+} // namespace E2PROMAsync
+
+#endif  // _E2PROM_ASYNC_HPP_
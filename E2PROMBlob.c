@@ -0,0 +1,393 @@
+#include "E2PROMBlob.h"
+#include "E2PROMCrc.h"
+
+#include <string.h>
+
+
+
+#define E2PROMBLOB_MAX_RUN              128
+#define E2PROMBLOB_MAX_LITERAL          128
+#define E2PROMBLOB_MIN_RUN              3
+
+
+
+/**
+ * @brief length of run of same bytes at pos
+ *
+ * @param packer Address of Packer
+ * @param pos    position in Data
+ * @param max    max length to check
+ * @return uint8_t
+ */
+static uint8_t E2PROMBlob_runLen(const E2PROMBlob_Packer* packer, uint16_t pos, uint8_t max) {
+    uint8_t len = 1;
+    while (len < max && pos + len < packer->Len && packer->Data[pos + len] == packer->Data[pos]) {
+        len++;
+    }
+    return len;
+}
+
+
+
+/**
+ * @brief choose next packet at Pos, a run of 3 or more bytes or literal bytes until next run
+ *
+ * @param packer Address of Packer
+ */
+static void E2PROMBlob_nextPacket(E2PROMBlob_Packer* packer) {
+    uint8_t len = E2PROMBlob_runLen(packer, packer->Pos, E2PROMBLOB_MAX_RUN);
+    if (len >= E2PROMBLOB_MIN_RUN) {
+        packer->Run    = 1;
+        packer->Repeat = len;
+        packer->Left   = 1;
+        packer->Header = (uint8_t)(257 - len);
+    } else {
+        len = 1;
+        while (len < E2PROMBLOB_MAX_LITERAL && packer->Pos + len < packer->Len &&
+               E2PROMBlob_runLen(packer, packer->Pos + len, E2PROMBLOB_MIN_RUN) < E2PROMBLOB_MIN_RUN) {
+            len++;
+        }
+        packer->Run    = 0;
+        packer->Left   = len;
+        packer->Header = len - 1;
+    }
+    packer->HeaderPending = 1;
+}
+
+
+
+/**
+ * @brief initial Packer for new data
+ *
+ * @param packer Address of Packer
+ * @param data   Address of data, must be valid until pack is finished
+ * @param len    Length of data
+ */
+void E2PROMBlob_packerInit(E2PROMBlob_Packer* packer, const uint8_t* data, uint16_t len) {
+    packer->Data          = data;
+    packer->Len           = len;
+    packer->Pos           = 0;
+    packer->Header        = 0;
+    packer->Left          = 0;
+    packer->Repeat        = 0;
+    packer->Run           = 0;
+    packer->HeaderPending = 0;
+}
+
+
+
+/**
+ * @brief pack next bytes of data, packets are same for any outLen so output can be cut anywhere
+ *
+ * @param packer Address of Packer
+ * @param out    Address of output, NULL only count the bytes
+ * @param outLen space of output
+ * @return uint16_t number of packed bytes, 0 when data is finished
+ */
+uint16_t E2PROMBlob_pack(E2PROMBlob_Packer* packer, uint8_t* out, uint16_t outLen) {
+    uint16_t len = 0;
+    uint8_t  value;
+    while (len < outLen) {
+        if (!packer->HeaderPending && packer->Left == 0) {
+            if (packer->Pos >= packer->Len) {
+                break;
+            }
+            E2PROMBlob_nextPacket(packer);
+        }
+        if (packer->HeaderPending) {
+            value                 = packer->Header;
+            packer->HeaderPending = 0;
+        }
+        else if (packer->Run) {
+            value         = packer->Data[packer->Pos];
+            packer->Pos  += packer->Repeat;
+            packer->Left  = 0;
+        }
+        else {
+            value = packer->Data[packer->Pos++];
+            packer->Left--;
+        }
+        if (out != NULL) {
+            out[len] = value;
+        }
+        len++;
+    }
+    return len;
+}
+
+
+
+/**
+ * @brief length of data after pack
+ *
+ * @param data Address of data
+ * @param len  Length of data
+ * @return uint16_t
+ */
+uint16_t E2PROMBlob_packedLen(const uint8_t* data, uint16_t len) {
+    E2PROMBlob_Packer packer;
+    uint16_t          packedLen = 0;
+    uint16_t          count;
+    E2PROMBlob_packerInit(&packer, data, len);
+    while ((count = E2PROMBlob_pack(&packer, NULL, 0xFFFF - packedLen)) > 0) {
+        packedLen += count;
+    }
+    return packedLen;
+}
+
+
+
+/**
+ * @brief initial Unpacker before first packed byte
+ *
+ * @param unpacker Address of Unpacker
+ */
+void E2PROMBlob_unpackerInit(E2PROMBlob_Unpacker* unpacker) {
+    unpacker->Left      = 0;
+    unpacker->Value     = 0;
+    unpacker->Run       = 0;
+    unpacker->NeedValue = 0;
+}
+
+
+
+/**
+ * @brief unpack a piece of packed data, stop when input is finished or output is full
+ *
+ * @param unpacker Address of Unpacker
+ * @param in       packed bytes
+ * @param inLen    number of packed bytes
+ * @param consumed number of packed bytes used, rest must be given in next call
+ * @param out      Address of output
+ * @param outLen   space of output
+ * @return uint16_t number of bytes in output
+ */
+uint16_t E2PROMBlob_unpack(E2PROMBlob_Unpacker* unpacker, const uint8_t* in, uint16_t inLen, uint16_t* consumed, uint8_t* out, uint16_t outLen) {
+    uint16_t inPos  = 0;
+    uint16_t outPos = 0;
+    uint16_t len;
+    uint8_t  header;
+    while (outPos < outLen) {
+        if (unpacker->Left == 0) {
+            if (inPos >= inLen) {
+                break;
+            }
+            header = in[inPos++];
+            if (header < 0x80) {
+                unpacker->Run  = 0;
+                unpacker->Left = header + 1;
+            }
+            else if (header > 0x80) {
+                unpacker->Run       = 1;
+                unpacker->NeedValue = 1;
+                unpacker->Left      = (uint8_t)(257 - header);
+            }
+            // 0x80 is no operation
+            continue;
+        }
+        len = outLen - outPos;
+        if (len > unpacker->Left) {
+            len = unpacker->Left;
+        }
+        if (unpacker->Run) {
+            if (unpacker->NeedValue) {
+                if (inPos >= inLen) {
+                    break;
+                }
+                unpacker->Value     = in[inPos++];
+                unpacker->NeedValue = 0;
+            }
+            memset(&out[outPos], unpacker->Value, len);
+        }
+        else {
+            if (len > inLen - inPos) {
+                len = inLen - inPos;
+            }
+            if (len == 0) {
+                break;
+            }
+            memcpy(&out[outPos], &in[inPos], len);
+            inPos += len;
+        }
+        outPos         += len;
+        unpacker->Left -= (uint8_t)len;
+    }
+    if (consumed != NULL) {
+        *consumed = inPos;
+    }
+    return outPos;
+}
+
+
+
+/**
+ * @brief start write of a blob, data is packed once to know its length, then process queue it chunk by chunk
+ *
+ * @param writer   Address of Writer
+ * @param eeprom   Address of E2PROM
+ * @param addr     Address of blob on chip
+ * @param capacity bytes reserved for blob on chip, with header
+ * @param data     Address of data, must be valid until writeProcess return E2PROM_Ok
+ * @param len      Length of data
+ * @return E2PROM_Result E2PROM_Busy if WriteStream is full, call E2PROMBlob_writeProcess later
+ */
+E2PROM_Result E2PROMBlob_writeBegin(E2PROMBlob_Writer* writer, E2PROM* eeprom, uint16_t addr, uint16_t capacity, const uint8_t* data, uint16_t len) {
+    uint16_t packedLen;
+    if ((uint32_t)addr + capacity > eeprom->Config->Size || capacity < E2PROMBLOB_HEADER_SIZE ||
+        (uint32_t)E2PROMBLOB_MAX_PACKED((uint32_t)len) > 0xFFFF) {
+        return E2PROM_HeaderValueError;
+    }
+    packedLen = E2PROMBlob_packedLen(data, len);
+    if (packedLen > capacity - E2PROMBLOB_HEADER_SIZE) {
+        return E2PROM_HeaderValueError;
+    }
+    writer->Eeprom           = eeprom;
+    writer->Address          = addr;
+    writer->Header.Magic     = E2PROMBLOB_MAGIC;
+    writer->Header.RawLen    = len;
+    writer->Header.PackedLen = packedLen;
+    writer->Header.Crc       = E2PROMCrc_calc(data, len);
+    writer->HeaderPending    = 1;
+    E2PROMBlob_packerInit(&writer->Packer, data, len);
+    return E2PROMBlob_writeProcess(writer);
+}
+
+
+
+/**
+ * @brief queue packed chunks while E2PROM has space, header is in first chunk and chunks end on page boundaries,
+ *        so each page is programmed once when E2PROMBLOB_CHUNK_SIZE >= PageSize, and once per chunk if not
+ *
+ * @param writer Address of Writer
+ * @return E2PROM_Result E2PROM_Ok when all of blob is queued, E2PROM_Busy if must call again
+ */
+E2PROM_Result E2PROMBlob_writeProcess(E2PROMBlob_Writer* writer) {
+    E2PROM*           eeprom   = writer->Eeprom;
+    uint8_t           pageSize = eeprom->Config->PageSize;
+    uint16_t          pos;
+    uint16_t          len;
+    E2PROMBlob_Packer next;
+    E2PROM_Result     result;
+    while (1) {
+        pos = 0;
+        if (writer->HeaderPending) {
+            memcpy(writer->Chunk, &writer->Header, E2PROMBLOB_HEADER_SIZE);
+            pos = E2PROMBLOB_HEADER_SIZE;
+        }
+        len = pos + pageSize - ((writer->Address + pos) % pageSize);
+        if (len > E2PROMBLOB_CHUNK_SIZE) {
+            len = E2PROMBLOB_CHUNK_SIZE;
+        }
+        // pack on a copy, packer moves only if chunk is queued
+        next = writer->Packer;
+        len  = pos + E2PROMBlob_pack(&next, &writer->Chunk[pos], len - pos);
+        if (len == 0) {
+            return E2PROM_Ok;
+        }
+        result = E2PROM_write(eeprom, writer->Address, writer->Chunk, len, E2PROM_Variable);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+        writer->Packer        = next;
+        writer->Address      += len;
+        writer->HeaderPending = 0;
+    }
+}
+
+
+
+/**
+ * @brief read and check header of blob, Blocking
+ *
+ * @param reader Address of Reader
+ * @param eeprom Address of E2PROM
+ * @param addr   Address of blob on chip
+ * @return E2PROM_Result E2PROM_HeaderValueError if there is no blob
+ */
+E2PROM_Result E2PROMBlob_open(E2PROMBlob_Reader* reader, E2PROM* eeprom, uint16_t addr) {
+    E2PROMBlob_Header header;
+    E2PROM_Result     result;
+    if ((uint32_t)addr + E2PROMBLOB_HEADER_SIZE > eeprom->Config->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    result = E2PROM_readBlocking(eeprom, addr, (uint8_t*)&header, E2PROMBLOB_HEADER_SIZE);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    if (header.Magic != E2PROMBLOB_MAGIC ||
+        header.PackedLen > E2PROMBLOB_MAX_PACKED((uint32_t)header.RawLen) ||
+        (uint32_t)addr + E2PROMBLOB_HEADER_SIZE + header.PackedLen > eeprom->Config->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    reader->Eeprom     = eeprom;
+    reader->Address    = addr + E2PROMBLOB_HEADER_SIZE;
+    reader->PackedLeft = header.PackedLen;
+    reader->RawLen     = header.RawLen;
+    reader->RawLeft    = header.RawLen;
+    reader->Crc        = header.Crc;
+    reader->CrcCalc    = E2PROM_CRC_INIT;
+    reader->ChunkPos   = 0;
+    reader->ChunkLen   = 0;
+    E2PROMBlob_unpackerInit(&reader->Unpacker);
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief length of blob data before pack
+ *
+ * @param reader Address of Reader
+ * @return uint16_t
+ */
+uint16_t E2PROMBlob_size(E2PROMBlob_Reader* reader) {
+    return reader->RawLen;
+}
+
+
+
+/**
+ * @brief read next bytes of blob, can be called with any len until whole blob is read
+ *
+ * @param reader  Address of Reader
+ * @param buffer  Address of buffer
+ * @param len     space of buffer
+ * @param readLen number of bytes put in buffer, 0 at end of blob
+ * @return E2PROM_Result E2PROM_Error if packed data or crc is wrong
+ */
+E2PROM_Result E2PROMBlob_read(E2PROMBlob_Reader* reader, uint8_t* buffer, uint16_t len, uint16_t* readLen) {
+    E2PROM_Result result;
+    uint16_t      consumed;
+    uint16_t      count;
+    *readLen = 0;
+    if (len > reader->RawLeft) {
+        len = reader->RawLeft;
+    }
+    while (*readLen < len) {
+        count = E2PROMBlob_unpack(&reader->Unpacker, &reader->Chunk[reader->ChunkPos], reader->ChunkLen - reader->ChunkPos,
+                                  &consumed, &buffer[*readLen], len - *readLen);
+        reader->ChunkPos += (uint8_t)consumed;
+        reader->CrcCalc   = E2PROMCrc_update(reader->CrcCalc, &buffer[*readLen], count);
+        *readLen         += count;
+        if (count == 0 && consumed == 0) {
+            // chunk is finished, unpacker need more packed bytes
+            if (reader->PackedLeft == 0) {
+                return E2PROM_Error;
+            }
+            reader->ChunkLen = reader->PackedLeft < E2PROMBLOB_CHUNK_SIZE ? (uint8_t)reader->PackedLeft : E2PROMBLOB_CHUNK_SIZE;
+            reader->ChunkPos = 0;
+            result = E2PROM_readBlocking(reader->Eeprom, reader->Address, reader->Chunk, reader->ChunkLen);
+            if (result != E2PROM_Ok) {
+                reader->ChunkLen = 0;
+                return result;
+            }
+            reader->Address    += reader->ChunkLen;
+            reader->PackedLeft -= reader->ChunkLen;
+        }
+    }
+    reader->RawLeft -= *readLen;
+    if (reader->RawLeft == 0 && len > 0 && reader->CrcCalc != reader->Crc) {
+        return E2PROM_Error;
+    }
+    return E2PROM_Ok;
+}
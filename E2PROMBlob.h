@@ -0,0 +1,138 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMBlob.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief compressed blobs (calibration tables, lookup tables) on top of E2PROM, PackBits RLE
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+#ifndef _E2PROM_BLOB_H_
+#define _E2PROM_BLOB_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "E2PROM.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief size of chunk buffer of writer and reader, at least E2PROMBLOB_HEADER_SIZE,
+ *        writer program each page once when it is >= PageSize
+ */
+#define E2PROMBLOB_CHUNK_SIZE           32
+
+/**************************************************************************************************/
+
+
+
+/**
+ * @brief header at start of blob on the chip, packed data is after it
+ */
+typedef struct {
+    uint16_t Magic;     /**< E2PROMBLOB_MAGIC */
+    uint16_t RawLen;    /**< length of data before pack */
+    uint16_t PackedLen; /**< length of packed data after header */
+    uint16_t Crc;       /**< crc of data before pack */
+} E2PROMBlob_Header;
+
+#define E2PROMBLOB_MAGIC                0xB10B
+#define E2PROMBLOB_HEADER_SIZE          sizeof(E2PROMBlob_Header)
+/**
+ * @brief worst case of packed length, every 128 bytes need 1 more byte
+ */
+#define E2PROMBLOB_MAX_PACKED(LEN)      ((LEN) + ((LEN) + 127) / 128)
+
+
+
+/**
+ * @brief PackBits encoder, can stop at any byte and continue later
+ */
+typedef struct {
+    const uint8_t* Data;
+    uint16_t       Len;
+    uint16_t       Pos;               /**< next byte of Data not packed yet */
+    uint8_t        Header;            /**< header of current packet */
+    uint8_t        Left;              /**< bytes of current packet not emitted yet */
+    uint8_t        Repeat;            /**< length of current run */
+    uint8_t        Run           : 1; /**< current packet is a run */
+    uint8_t        HeaderPending : 1;
+    uint8_t        Reserved      : 6;
+} E2PROMBlob_Packer;
+
+
+
+/**
+ * @brief PackBits decoder, packed data can be given in any pieces
+ */
+typedef struct {
+    uint8_t Left;           /**< bytes of current packet not produced yet */
+    uint8_t Value;          /**< byte of current run */
+    uint8_t Run       : 1;
+    uint8_t NeedValue : 1;  /**< byte of run not received yet */
+    uint8_t Reserved  : 6;
+} E2PROMBlob_Unpacker;
+
+
+
+/**
+ * @brief non-blocking writer, push packed chunks to WriteStream while it has space
+ */
+typedef struct {
+    E2PROM*           Eeprom;
+    E2PROMBlob_Packer Packer;
+    E2PROMBlob_Header Header;
+    uint16_t          Address;       /**< next address of chip */
+    uint8_t           HeaderPending;
+    uint8_t           Chunk[E2PROMBLOB_CHUNK_SIZE];
+} E2PROMBlob_Writer;
+
+
+
+/**
+ * @brief reader, read packed chunks Blocking and unpack them into user buffer
+ */
+typedef struct {
+    E2PROM*             Eeprom;
+    E2PROMBlob_Unpacker Unpacker;
+    uint16_t            Address;     /**< next packed byte on chip */
+    uint16_t            PackedLeft;
+    uint16_t            RawLen;
+    uint16_t            RawLeft;
+    uint16_t            Crc;         /**< expected crc */
+    uint16_t            CrcCalc;
+    uint8_t             ChunkPos;
+    uint8_t             ChunkLen;
+    uint8_t             Chunk[E2PROMBLOB_CHUNK_SIZE];
+} E2PROMBlob_Reader;
+
+
+
+void          E2PROMBlob_packerInit(E2PROMBlob_Packer* packer, const uint8_t* data, uint16_t len);
+uint16_t      E2PROMBlob_pack(E2PROMBlob_Packer* packer, uint8_t* out, uint16_t outLen);
+uint16_t      E2PROMBlob_packedLen(const uint8_t* data, uint16_t len);
+
+void          E2PROMBlob_unpackerInit(E2PROMBlob_Unpacker* unpacker);
+uint16_t      E2PROMBlob_unpack(E2PROMBlob_Unpacker* unpacker, const uint8_t* in, uint16_t inLen, uint16_t* consumed, uint8_t* out, uint16_t outLen);
+
+E2PROM_Result E2PROMBlob_writeBegin(E2PROMBlob_Writer* writer, E2PROM* eeprom, uint16_t addr, uint16_t capacity, const uint8_t* data, uint16_t len);
+E2PROM_Result E2PROMBlob_writeProcess(E2PROMBlob_Writer* writer);
+
+E2PROM_Result E2PROMBlob_open(E2PROMBlob_Reader* reader, E2PROM* eeprom, uint16_t addr);
+uint16_t      E2PROMBlob_size(E2PROMBlob_Reader* reader);
+E2PROM_Result E2PROMBlob_read(E2PROMBlob_Reader* reader, uint8_t* buffer, uint16_t len, uint16_t* readLen);
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_BLOB_H_
@@ -0,0 +1,53 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMCrc.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief CRC helpers shared by the E2PROM storage layers
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+#ifndef _E2PROM_CRC_H_
+#define _E2PROM_CRC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief initial value of CRC-16/CCITT-FALSE
+ */
+#define E2PROM_CRC_INIT                 0xFFFF
+
+/**
+ * @brief use 512 byte table in flash for CRC, 0 for bitwise CRC without table
+ */
+#define E2PROM_CRC_TABLE                1
+
+/**************************************************************************************************/
+
+
+
+/**
+ * @brief hardware CRC, must continue crc with data same as CRC-16/CCITT-FALSE (poly 0x1021, no reflect, no xor out)
+ */
+typedef uint16_t (*E2PROMCrc_HardwareFn)(uint16_t crc, const uint8_t* data, uint16_t len);
+
+void     E2PROMCrc_setHardware(E2PROMCrc_HardwareFn fn);
+uint16_t E2PROMCrc_update(uint16_t crc, const uint8_t* data, uint16_t len);
+uint16_t E2PROMCrc_calc(const uint8_t* data, uint16_t len);
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_CRC_H_
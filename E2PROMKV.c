@@ -0,0 +1,416 @@
+#include "E2PROMKV.h"
+
+#include <string.h>
+
+
+
+#define __hash(KV, KEY)     ((uint16_t)(((uint32_t)(KEY) * 2654435761U) >> 16) & (KV)->IndexMask)
+#define __isEmpty(ENTRY)    ((ENTRY)->Offset == 0)
+
+
+
+/**
+ * @brief initial the KV store, after this u must format or mount it
+ *
+ * @param kv           Address of KV Struct
+ * @param eeprom       Address of E2PROM
+ * @param startAddress first address of store region, aligned to PageSize
+ * @param pages        number of pages in store region
+ * @param pageBuffer   staging buffer of log, PageSize bytes
+ * @param buffer       work buffer, PageSize bytes
+ * @param index        RAM index
+ * @param indexLen     number of index entries, must be power of 2
+ */
+void E2PROMKV_init(E2PROMKV* kv, E2PROM* eeprom, uint16_t startAddress, uint16_t pages, uint8_t* pageBuffer, uint8_t* buffer, E2PROMKV_Entry* index, uint16_t indexLen) {
+    E2PROMLog_init(&kv->Log, eeprom, startAddress, pages, pageBuffer);
+    kv->Index     = index;
+    kv->Buffer    = buffer;
+    kv->IndexMask = indexLen - 1;
+    kv->Keys      = 0;
+    memset(index, 0, sizeof(E2PROMKV_Entry) * indexLen);
+}
+
+
+
+/**
+ * @brief find the index slot of key, or empty slot where key must be inserted
+ *
+ * @param kv  Address of KV Struct
+ * @param key
+ * @return E2PROMKV_Entry* return NULL if key not exists and index is full
+ */
+static E2PROMKV_Entry* E2PROMKV_findSlot(E2PROMKV* kv, E2PROMKV_Key key) {
+    uint16_t slot = __hash(kv, key);
+    for (uint16_t i = 0; i <= kv->IndexMask; i++) {
+        if (__isEmpty(&kv->Index[slot]) || kv->Index[slot].Key == key) {
+            return &kv->Index[slot];
+        }
+        slot = (slot + 1) & kv->IndexMask;
+    }
+    return NULL;
+}
+
+
+
+/**
+ * @brief find index entry of key
+ *
+ * @param kv  Address of KV Struct
+ * @param key
+ * @return E2PROMKV_Entry* return NULL if key not exists
+ */
+static E2PROMKV_Entry* E2PROMKV_find(E2PROMKV* kv, E2PROMKV_Key key) {
+    E2PROMKV_Entry* entry = E2PROMKV_findSlot(kv, key);
+    return (entry != NULL && !__isEmpty(entry)) ? entry : NULL;
+}
+
+
+
+/**
+ * @brief point index entry of key to a record
+ *
+ * @param kv       Address of KV Struct
+ * @param key
+ * @param location Location of record
+ * @return E2PROM_Result
+ */
+static E2PROM_Result E2PROMKV_setEntry(E2PROMKV* kv, E2PROMKV_Key key, const E2PROMLog_Location* location) {
+    E2PROMKV_Entry* entry = E2PROMKV_findSlot(kv, key);
+    if (entry == NULL) {
+        return E2PROM_Error;
+    }
+    if (__isEmpty(entry)) {
+        kv->Keys++;
+    }
+    entry->Key    = key;
+    entry->Page   = location->Page;
+    entry->Offset = location->Offset;
+    entry->Len    = location->Len - E2PROMKV_KEY_SIZE;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief remove an entry from index, following entries of the probe chain shift back
+ *
+ * @param kv    Address of KV Struct
+ * @param entry Address of index entry
+ */
+static void E2PROMKV_removeEntry(E2PROMKV* kv, E2PROMKV_Entry* entry) {
+    uint16_t slot = entry - kv->Index;
+    uint16_t next = slot;
+    uint16_t home;
+    for (;;) {
+        next = (next + 1) & kv->IndexMask;
+        if (__isEmpty(&kv->Index[next])) {
+            break;
+        }
+        home = __hash(kv, kv->Index[next].Key);
+        if (((next - home) & kv->IndexMask) >= ((next - slot) & kv->IndexMask)) {
+            kv->Index[slot] = kv->Index[next];
+            slot            = next;
+        }
+    }
+    kv->Index[slot].Offset = 0;
+    kv->Keys--;
+}
+
+
+
+/**
+ * @brief remove index entries that point to a page
+ *
+ * @param kv   Address of KV Struct
+ * @param page page index inside the log region
+ */
+static void E2PROMKV_forgetPage(E2PROMKV* kv, uint16_t page) {
+    E2PROMKV_Entry* entry;
+    uint16_t        slot = 0;
+    while (slot <= kv->IndexMask) {
+        entry = &kv->Index[slot];
+        if (!__isEmpty(entry) && entry->Page == page) {
+            // next entry may shift into this slot
+            E2PROMKV_removeEntry(kv, entry);
+        } else {
+            slot++;
+        }
+    }
+}
+
+
+
+/**
+ * @brief move live records of oldest page to the head and drop the page
+ *        removed keys found in oldest page are forgotten, no older record of them can exist
+ *        records of a corrupted oldest page can not be moved, their keys are forgotten
+ *        if oldest page can not be read, it is kept and the bus error is returned
+ *
+ * @param kv Address of KV Struct
+ * @return E2PROM_Result
+ */
+static E2PROM_Result E2PROMKV_collect(E2PROMKV* kv) {
+    E2PROMLog_Cursor   cursor;
+    E2PROMLog_Location location;
+    E2PROMKV_Entry*    entry;
+    E2PROMKV_Key       key;
+    E2PROM_Result      result;
+    E2PROM_Result      next;
+    uint16_t           page = kv->Log.Tail;
+    uint8_t            len;
+
+    E2PROMLog_openTailCursor(&kv->Log, &cursor, kv->Buffer);
+    next = E2PROMLog_next(&kv->Log, &cursor, NULL, &len);
+    if (next == E2PROM_Null) {
+        // page was read but is corrupted or empty, nothing of it can be moved
+        E2PROMKV_forgetPage(kv, page);
+    } else if (next != E2PROM_Ok) {
+        // page could not be read, keep it and its keys, collect is tried again later
+        return next;
+    }
+    // page image is in Buffer now, drop it first so relocation flushes never overwrite a live page
+    E2PROMLog_dropTail(&kv->Log);
+    while (next == E2PROM_Ok) {
+        entry = NULL;
+        if (len >= E2PROMKV_KEY_SIZE) {
+            memcpy(&key, cursor.Record, E2PROMKV_KEY_SIZE);
+            entry = E2PROMKV_find(kv, key);
+        }
+        if (entry != NULL && entry->Page == cursor.Location.Page && entry->Offset == cursor.Location.Offset) {
+            if (entry->Len == 0) {
+                E2PROMKV_removeEntry(kv, entry);
+            } else {
+                result = E2PROMLog_append(&kv->Log, cursor.Record, len, &location);
+                if (result != E2PROM_Ok) {
+                    // relocation flushed less pages than were free, so page is not overwritten yet,
+                    // take it back and records not moved stay in the log
+                    kv->Log.Tail = page;
+                    kv->Log.Count++;
+                    return result;
+                }
+                E2PROMKV_setEntry(kv, key, &location);
+            }
+        }
+        next = E2PROMLog_next(&kv->Log, &cursor, NULL, &len);
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief drop oldest pages without live records, no write needed
+ *        after mount the pages already collected before reset are found again this way
+ *
+ * @param kv Address of KV Struct
+ */
+static void E2PROMKV_trim(E2PROMKV* kv) {
+    E2PROMKV_Entry* entry;
+    uint16_t        slot;
+    while (kv->Log.Count > 0 && E2PROMLog_freePages(&kv->Log) < E2PROMKV_RESERVE_PAGES) {
+        for (slot = 0; slot <= kv->IndexMask; slot++) {
+            entry = &kv->Index[slot];
+            if (!__isEmpty(entry) && entry->Page == kv->Log.Tail && entry->Len > 0) {
+                return;
+            }
+        }
+        E2PROMKV_forgetPage(kv, kv->Log.Tail);
+        E2PROMLog_dropTail(&kv->Log);
+    }
+}
+
+
+
+/**
+ * @brief collect oldest pages until enough free pages for an append
+ *        records of oldest page and staged records flush at most 2 pages, so collect needs 2 free pages
+ *
+ * @param kv Address of KV Struct
+ * @return E2PROM_Result return E2PROM_Error if store is full of live records
+ */
+static E2PROM_Result E2PROMKV_reserve(E2PROMKV* kv) {
+    E2PROM_Result result;
+    uint16_t      tries = kv->Log.Pages;
+    while (E2PROMLog_freePages(&kv->Log) < E2PROMKV_RESERVE_PAGES) {
+        if (tries-- == 0 || E2PROMLog_freePages(&kv->Log) < 2) {
+            return E2PROM_Error;
+        }
+        result = E2PROMKV_collect(kv);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief erase the store, Blocking
+ *
+ * @param kv Address of KV Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMKV_format(E2PROMKV* kv) {
+    memset(kv->Index, 0, sizeof(E2PROMKV_Entry) * (kv->IndexMask + 1));
+    kv->Keys = 0;
+    return E2PROMLog_format(&kv->Log);
+}
+
+
+
+/**
+ * @brief mount the log and build RAM index from its records, Blocking
+ *
+ * @param kv Address of KV Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMKV_mount(E2PROMKV* kv) {
+    E2PROMLog_Cursor cursor;
+    E2PROMKV_Key     key;
+    uint8_t          len;
+    E2PROM_Result    result = E2PROMLog_mount(&kv->Log);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    memset(kv->Index, 0, sizeof(E2PROMKV_Entry) * (kv->IndexMask + 1));
+    kv->Keys = 0;
+
+    E2PROMLog_openCursor(&kv->Log, &cursor, kv->Buffer);
+    while ((result = E2PROMLog_next(&kv->Log, &cursor, NULL, &len)) == E2PROM_Ok) {
+        if (len < E2PROMKV_KEY_SIZE) {
+            continue;
+        }
+        memcpy(&key, cursor.Record, E2PROMKV_KEY_SIZE);
+        result = E2PROMKV_setEntry(kv, key, &cursor.Location);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+    }
+    if (result != E2PROM_Null) {
+        return result;
+    }
+    E2PROMKV_trim(kv);
+    return E2PROMKV_reserve(kv);
+}
+
+
+
+/**
+ * @brief max length of a value
+ *
+ * @param kv Address of KV Struct
+ * @return uint8_t
+ */
+uint8_t E2PROMKV_maxValueLen(E2PROMKV* kv) {
+    return E2PROMLog_maxRecordLen(&kv->Log) - E2PROMKV_KEY_SIZE;
+}
+
+
+
+/**
+ * @brief append a new version of key, record reach the chip when its page is full or at E2PROMKV_sync
+ *
+ * @param kv    Address of KV Struct
+ * @param key
+ * @param value Address of value
+ * @param len   Length of value
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMKV_put(E2PROMKV* kv, E2PROMKV_Key key, const uint8_t* value, uint8_t len) {
+    E2PROMLog_Location location;
+    E2PROM_Result      result;
+    if (len == 0 || len > E2PROMKV_maxValueLen(kv)) {
+        return E2PROM_HeaderValueError;
+    }
+    if (E2PROMKV_findSlot(kv, key) == NULL) {
+        return E2PROM_Error;
+    }
+    result = E2PROMKV_reserve(kv);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    memcpy(kv->Buffer, &key, E2PROMKV_KEY_SIZE);
+    memcpy(kv->Buffer + E2PROMKV_KEY_SIZE, value, len);
+    result = E2PROMLog_append(&kv->Log, kv->Buffer, E2PROMKV_KEY_SIZE + len, &location);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    E2PROMKV_setEntry(kv, key, &location);
+    // record is staged, pages not reserved now are reserved before next append
+    E2PROMKV_reserve(kv);
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief read latest value of key with one read from the chip
+ *
+ * @param kv    Address of KV Struct
+ * @param key
+ * @param value buffer for value
+ * @param len   size of value buffer, return length of value
+ * @return E2PROM_Result return E2PROM_Null if key not exists
+ */
+E2PROM_Result E2PROMKV_get(E2PROMKV* kv, E2PROMKV_Key key, uint8_t* value, uint8_t* len) {
+    E2PROMLog_Location location;
+    E2PROMKV_Entry*    entry = E2PROMKV_find(kv, key);
+    if (entry == NULL || entry->Len == 0) {
+        return E2PROM_Null;
+    }
+    if (*len < entry->Len) {
+        *len = entry->Len;
+        return E2PROM_HeaderValueError;
+    }
+    location.Page   = entry->Page;
+    location.Offset = entry->Offset + E2PROMKV_KEY_SIZE;
+    location.Len    = entry->Len;
+    *len            = entry->Len;
+    return E2PROMLog_readAt(&kv->Log, &location, value);
+}
+
+
+
+/**
+ * @brief remove key, a record without value is appended
+ *
+ * @param kv  Address of KV Struct
+ * @param key
+ * @return E2PROM_Result return E2PROM_Null if key not exists
+ */
+E2PROM_Result E2PROMKV_remove(E2PROMKV* kv, E2PROMKV_Key key) {
+    E2PROMLog_Location location;
+    E2PROM_Result      result;
+    E2PROMKV_Entry*    entry = E2PROMKV_find(kv, key);
+    if (entry == NULL || entry->Len == 0) {
+        return E2PROM_Null;
+    }
+    result = E2PROMKV_reserve(kv);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    result = E2PROMLog_append(&kv->Log, (const uint8_t*)&key, E2PROMKV_KEY_SIZE, &location);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    E2PROMKV_setEntry(kv, key, &location);
+    E2PROMKV_reserve(kv);
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief program staged records
+ *
+ * @param kv Address of KV Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMKV_sync(E2PROMKV* kv) {
+    E2PROM_Result result = E2PROMLog_flush(&kv->Log);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    return E2PROMKV_reserve(kv);
+}
@@ -0,0 +1,84 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMKV.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief wear levelled key-value store on top of E2PROMLog
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+#ifndef _E2PROM_KV_H_
+#define _E2PROM_KV_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "E2PROMLog.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief free pages kept in the log, garbage collection of oldest page needs 2 of them
+ */
+#define E2PROMKV_RESERVE_PAGES          3
+
+/**************************************************************************************************/
+
+
+
+/**
+ * @brief Key Type
+ */
+typedef uint16_t E2PROMKV_Key;
+
+#define E2PROMKV_KEY_SIZE               sizeof(E2PROMKV_Key)
+
+
+
+/**
+ * @brief RAM index entry, Offset 0 means empty slot
+ */
+typedef struct {
+    E2PROMKV_Key Key;
+    uint16_t     Page;   /**< page index of latest record */
+    uint8_t      Offset; /**< offset of record inside the page */
+    uint8_t      Len;    /**< length of value, 0 for removed key */
+} E2PROMKV_Entry;
+
+
+
+/**
+ * @brief KV main Struct
+ */
+typedef struct {
+    E2PROMLog       Log;
+    E2PROMKV_Entry* Index;
+    uint8_t*        Buffer;    /**< PageSize bytes, use for mount and garbage collection */
+    uint16_t        IndexMask; /**< number of index entries - 1 */
+    uint16_t        Keys;      /**< used index entries */
+} E2PROMKV;
+
+
+
+void          E2PROMKV_init(E2PROMKV* kv, E2PROM* eeprom, uint16_t startAddress, uint16_t pages, uint8_t* pageBuffer, uint8_t* buffer, E2PROMKV_Entry* index, uint16_t indexLen);
+E2PROM_Result E2PROMKV_format(E2PROMKV* kv);
+E2PROM_Result E2PROMKV_mount(E2PROMKV* kv);
+E2PROM_Result E2PROMKV_put(E2PROMKV* kv, E2PROMKV_Key key, const uint8_t* value, uint8_t len);
+E2PROM_Result E2PROMKV_get(E2PROMKV* kv, E2PROMKV_Key key, uint8_t* value, uint8_t* len);
+E2PROM_Result E2PROMKV_remove(E2PROMKV* kv, E2PROMKV_Key key);
+E2PROM_Result E2PROMKV_sync(E2PROMKV* kv);
+uint8_t       E2PROMKV_maxValueLen(E2PROMKV* kv);
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_KV_H_
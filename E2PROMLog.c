@@ -0,0 +1,460 @@
+#include "E2PROMLog.h"
+#include "E2PROMCrc.h"
+
+#include <stddef.h>
+#include <string.h>
+
+
+
+#define __pageSize(LOG)         ((LOG)->Eeprom->Config->PageSize)
+#define __pageAddress(LOG, P)   ((uint16_t)((LOG)->StartAddress + (uint16_t)(P) * __pageSize(LOG)))
+#define __pagePayload(LOG)      ((uint8_t)(__pageSize(LOG) - E2PROMLOG_HEADER_SIZE))
+
+
+
+/**
+ * @brief crc of page header (without Crc field) and records
+ *
+ * @param page Address of page image
+ * @param used bytes of records after header
+ * @return uint16_t
+ */
+static uint16_t E2PROMLog_pageCrc(const uint8_t* page, uint8_t used) {
+    uint16_t crc = E2PROMCrc_update(E2PROM_CRC_INIT, page, offsetof(E2PROMLog_PageHeader, Crc));
+    return E2PROMCrc_update(crc, page + E2PROMLOG_HEADER_SIZE, used);
+}
+
+
+
+/**
+ * @brief read a whole page and check it
+ *
+ * @param log    Address of Log Struct
+ * @param page   page index inside the log region
+ * @param buffer PageSize bytes
+ * @param header header of the page
+ * @return E2PROM_Result return E2PROM_HeaderValueError if page is read but not valid, other errors are from bus
+ */
+static E2PROM_Result E2PROMLog_readPage(E2PROMLog* log, uint16_t page, uint8_t* buffer, E2PROMLog_PageHeader* header) {
+    E2PROM_Result result = E2PROM_readBlocking(log->Eeprom, __pageAddress(log, page), buffer, __pageSize(log));
+    if (result != E2PROM_Ok) {
+        return result == E2PROM_HeaderValueError ? E2PROM_Error : result;
+    }
+    memcpy(header, buffer, E2PROMLOG_HEADER_SIZE);
+    if (header->Used > __pagePayload(log) || header->Crc != E2PROMLog_pageCrc(buffer, header->Used)) {
+        return E2PROM_HeaderValueError;
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief wait until flushed pages leave the WriteStream and write cycle of last one is over, before reading them back
+ *
+ * @param log Address of Log Struct
+ * @return E2PROM_Result E2PROM_TimeOutError if pages are still in write, log stays unsynced
+ */
+static E2PROM_Result E2PROMLog_sync(E2PROMLog* log) {
+    E2PROM_Result result = E2PROM_Ok;
+    if (log->Unsynced) {
+        result = E2PROM_waitWriteCycle(log->Eeprom, E2PROMLOG_SYNC_TIMEOUT);
+        if (result == E2PROM_Ok) {
+            log->Unsynced = 0;
+        }
+    }
+    return result;
+}
+
+
+
+/**
+ * @brief initial the Log, after this u must format or mount it
+ *
+ * @param log          Address of Log Struct
+ * @param eeprom       Address of E2PROM, must be added before mount
+ * @param startAddress first address of log region, aligned to PageSize
+ * @param pages        number of pages in log region
+ * @param pageBuffer   staging buffer, PageSize bytes
+ */
+void E2PROMLog_init(E2PROMLog* log, E2PROM* eeprom, uint16_t startAddress, uint16_t pages, uint8_t* pageBuffer) {
+    log->Eeprom       = eeprom;
+    log->StartAddress = startAddress;
+    log->Pages        = pages;
+    log->PageBuffer   = pageBuffer;
+    log->NextSeq      = 0;
+    log->Head         = 0;
+    log->Tail         = 0;
+    log->Count        = 0;
+    log->Used         = 0;
+    log->Records      = 0;
+    log->Unsynced     = 0;
+}
+
+
+
+/**
+ * @brief check log region against E2PROM Config
+ *
+ * @param log Address of Log Struct
+ * @return E2PROM_Result
+ */
+static E2PROM_Result E2PROMLog_checkRegion(E2PROMLog* log) {
+    if (log->Pages < 2 ||
+        __pageSize(log) <= E2PROMLOG_HEADER_SIZE + 1 ||
+        (log->StartAddress % __pageSize(log)) != 0 ||
+        (uint32_t)log->StartAddress + (uint32_t)log->Pages * __pageSize(log) > log->Eeprom->Config->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief invalidate all pages of log region, Blocking
+ *
+ * @param log Address of Log Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMLog_format(E2PROMLog* log) {
+    uint8_t       erased[E2PROMLOG_HEADER_SIZE];
+    E2PROM_Result result = E2PROMLog_checkRegion(log);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    memset(erased, E2PROM_DEFAULT_VALUE, sizeof(erased));
+    for (uint16_t page = 0; page < log->Pages; page++) {
+        result = E2PROM_writeBlocking(log->Eeprom, __pageAddress(log, page), erased, sizeof(erased));
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+    }
+    E2PROMLog_init(log, log->Eeprom, log->StartAddress, log->Pages, log->PageBuffer);
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief find head and tail of log with binary search over page sequence numbers, Blocking
+ *        pages [0, head] have sequence >= first page, and pages after head are older or empty
+ *
+ * @param log Address of Log Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMLog_mount(E2PROMLog* log) {
+    E2PROMLog_PageHeader header;
+    uint32_t             firstSeq;
+    uint32_t             headSeq;
+    uint16_t             lo;
+    uint16_t             hi;
+    uint16_t             mid;
+    E2PROM_Result        result = E2PROMLog_checkRegion(log);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    log->Used     = 0;
+    log->Records  = 0;
+    log->Unsynced = 0;
+
+    result = E2PROMLog_readPage(log, 0, log->PageBuffer, &header);
+    if (result == E2PROM_HeaderValueError) {
+        result = E2PROMLog_readPage(log, log->Pages - 1, log->PageBuffer, &header);
+        if (result == E2PROM_HeaderValueError) {
+            // empty log
+            log->NextSeq = 0;
+            log->Head    = 0;
+            log->Tail    = 0;
+            log->Count   = 0;
+        } else if (result == E2PROM_Ok) {
+            // page 0 torn while log wrapped, newest page is the last one
+            log->NextSeq = header.Seq + 1;
+            log->Head    = 0;
+            log->Tail    = 1;
+            log->Count   = log->Pages - 1;
+        } else {
+            return result;
+        }
+        return E2PROM_Ok;
+    } else if (result != E2PROM_Ok) {
+        return result;
+    }
+
+    firstSeq = header.Seq;
+    headSeq  = header.Seq;
+    lo       = 0;
+    hi       = log->Pages;
+    while (hi - lo > 1) {
+        mid    = lo + (hi - lo) / 2;
+        result = E2PROMLog_readPage(log, mid, log->PageBuffer, &header);
+        if (result != E2PROM_Ok && result != E2PROM_HeaderValueError) {
+            return result;
+        }
+        if (result == E2PROM_Ok && header.Seq >= firstSeq) {
+            lo      = mid;
+            headSeq = header.Seq;
+        } else {
+            hi = mid;
+        }
+    }
+
+    log->NextSeq = headSeq + 1;
+    log->Head    = (lo + 1) % log->Pages;
+    log->Tail    = 0;
+    log->Count   = lo + 1;
+    // older pages after head mean the log is wrapped, head page itself may be torn so page after it is checked too
+    for (mid = lo + 1; mid < log->Pages && mid <= lo + 2; mid++) {
+        result = E2PROMLog_readPage(log, mid, log->PageBuffer, &header);
+        if (result != E2PROM_Ok && result != E2PROM_HeaderValueError) {
+            return result;
+        }
+        if (result == E2PROM_Ok && header.Seq < firstSeq) {
+            log->Tail  = mid;
+            log->Count = log->Pages - (mid - log->Head);
+            break;
+        }
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief max length of a record that fit in one page
+ *
+ * @param log Address of Log Struct
+ * @return uint8_t
+ */
+uint8_t E2PROMLog_maxRecordLen(E2PROMLog* log) {
+    return __pagePayload(log) - 1;
+}
+
+
+
+/**
+ * @brief number of pages can be flushed before oldest page be overwritten
+ *
+ * @param log Address of Log Struct
+ * @return uint16_t
+ */
+uint16_t E2PROMLog_freePages(E2PROMLog* log) {
+    return log->Pages - log->Count;
+}
+
+
+
+/**
+ * @brief append a record to staging page, staging page flushed when it is full
+ *        when a full staging page can not be flushed now, it is flushed by next append or E2PROMLog_flush
+ *
+ * @param log      Address of Log Struct
+ * @param data     Address of record
+ * @param len      Length of record
+ * @param location where record is stored, can be NULL
+ * @return E2PROM_Result return E2PROM_Ok when record is staged, if not it is not staged and can be appended again
+ */
+E2PROM_Result E2PROMLog_append(E2PROMLog* log, const uint8_t* data, uint8_t len, E2PROMLog_Location* location) {
+    E2PROM_Result result;
+    uint8_t*      record;
+    if (len == 0 || len > E2PROMLog_maxRecordLen(log)) {
+        return E2PROM_HeaderValueError;
+    }
+    if (log->Used + 1 + len > __pagePayload(log)) {
+        result = E2PROMLog_flush(log);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+    }
+    record    = log->PageBuffer + E2PROMLOG_HEADER_SIZE + log->Used;
+    record[0] = len;
+    memcpy(record + 1, data, len);
+    if (location != NULL) {
+        location->Page   = log->Head;
+        location->Offset = E2PROMLOG_HEADER_SIZE + log->Used + 1;
+        location->Len    = len;
+    }
+    log->Used += 1 + len;
+    log->Records++;
+    // no room for another record, record is staged even if page can not be flushed now
+    if (__pagePayload(log) - log->Used < 2) {
+        E2PROMLog_flush(log);
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief program the staging page into head page, NonBlocking
+ *        a flushed page is closed, next records go to the next page
+ *
+ * @param log Address of Log Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMLog_flush(E2PROMLog* log) {
+    E2PROMLog_PageHeader header;
+    E2PROM_Result        result;
+    if (log->Used == 0) {
+        return E2PROM_Ok;
+    }
+    header.Seq   = log->NextSeq;
+    header.Used  = log->Used;
+    header.Count = log->Records;
+    header.Crc   = 0;
+    memcpy(log->PageBuffer, &header, E2PROMLOG_HEADER_SIZE);
+    header.Crc   = E2PROMLog_pageCrc(log->PageBuffer, log->Used);
+    memcpy(log->PageBuffer, &header, E2PROMLOG_HEADER_SIZE);
+
+    result = E2PROM_write(log->Eeprom, __pageAddress(log, log->Head), log->PageBuffer, E2PROMLOG_HEADER_SIZE + log->Used, E2PROM_Variable);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    if (log->Count == log->Pages) {
+        log->Tail = (log->Tail + 1) % log->Pages;
+    } else {
+        log->Count++;
+    }
+    log->Head     = (log->Head + 1) % log->Pages;
+    log->NextSeq++;
+    log->Used     = 0;
+    log->Records  = 0;
+    log->Unsynced = 1;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief read a record from its location, records of staging page come from RAM
+ *        location must not be on a page dropped from the log, when log is full
+ *        tail page is dropped as soon as a record is staged on its place
+ *
+ * @param log      Address of Log Struct
+ * @param location Address of record Location
+ * @param data     buffer for record, location->Len bytes
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMLog_readAt(E2PROMLog* log, const E2PROMLog_Location* location, uint8_t* data) {
+    if (location->Page >= log->Pages || location->Offset + location->Len > __pageSize(log)) {
+        return E2PROM_HeaderValueError;
+    }
+    if (location->Page == log->Head && (log->Count < log->Pages || log->Used > 0)) {
+        memcpy(data, log->PageBuffer + location->Offset, location->Len);
+        return E2PROM_Ok;
+    }
+    E2PROM_Result result = E2PROMLog_sync(log);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    return E2PROM_readBlocking(log->Eeprom, __pageAddress(log, location->Page) + location->Offset, data, location->Len);
+}
+
+
+
+/**
+ * @brief drop oldest page from the log, its records must be appended again before if still needed
+ *
+ * @param log Address of Log Struct
+ */
+void E2PROMLog_dropTail(E2PROMLog* log) {
+    if (log->Count > 0) {
+        log->Tail = (log->Tail + 1) % log->Pages;
+        log->Count--;
+    }
+}
+
+
+
+/**
+ * @brief open a cursor on oldest record
+ *
+ * @param log    Address of Log Struct
+ * @param cursor Address of Cursor Struct
+ * @param buffer PageSize bytes for read pages
+ */
+void E2PROMLog_openCursor(E2PROMLog* log, E2PROMLog_Cursor* cursor, uint8_t* buffer) {
+    cursor->Buffer     = buffer;
+    cursor->Seq        = 0;
+    cursor->Page       = log->Tail;
+    cursor->Remaining  = log->Count;
+    cursor->Offset     = 0;
+    cursor->End        = 0;
+    cursor->Staged     = 0;
+    cursor->SkipStaged = 0;
+}
+
+
+
+/**
+ * @brief open a cursor only on records of oldest programmed page
+ *
+ * @param log    Address of Log Struct
+ * @param cursor Address of Cursor Struct
+ * @param buffer PageSize bytes for read pages
+ */
+void E2PROMLog_openTailCursor(E2PROMLog* log, E2PROMLog_Cursor* cursor, uint8_t* buffer) {
+    E2PROMLog_openCursor(log, cursor, buffer);
+    cursor->Remaining  = log->Count > 0 ? 1 : 0;
+    cursor->SkipStaged = 1;
+}
+
+
+
+/**
+ * @brief read next record, programmed pages first and then staging page
+ *        corrupted pages are skipped, a page that can not be read returns error and is read again by next call
+ *
+ * @param log    Address of Log Struct
+ * @param cursor Address of Cursor Struct
+ * @param data   buffer for record, at least E2PROMLog_maxRecordLen bytes, can be NULL and use cursor->Record
+ * @param len    Length of record
+ * @return E2PROM_Result return E2PROM_Null at end of log
+ */
+E2PROM_Result E2PROMLog_next(E2PROMLog* log, E2PROMLog_Cursor* cursor, uint8_t* data, uint8_t* len) {
+    E2PROMLog_PageHeader header;
+    E2PROM_Result        result;
+    const uint8_t*       page;
+    if (cursor->Staged) {
+        cursor->End = E2PROMLOG_HEADER_SIZE + log->Used;
+    }
+    while (cursor->Offset >= cursor->End) {
+        if (cursor->Remaining > 0) {
+            result = E2PROMLog_sync(log);
+            if (result == E2PROM_Ok) {
+                result = E2PROMLog_readPage(log, cursor->Page, cursor->Buffer, &header);
+            }
+            if (result != E2PROM_Ok && result != E2PROM_HeaderValueError) {
+                // page stays on cursor, next call reads it again
+                return result;
+            }
+            if (result == E2PROM_Ok) {
+                cursor->Seq    = header.Seq;
+                cursor->Offset = E2PROMLOG_HEADER_SIZE;
+                cursor->End    = E2PROMLOG_HEADER_SIZE + header.Used;
+            }
+            cursor->Location.Page = cursor->Page;
+            cursor->Page          = (cursor->Page + 1) % log->Pages;
+            cursor->Remaining--;
+        } else if (!cursor->Staged && !cursor->SkipStaged) {
+            cursor->Staged        = 1;
+            cursor->Seq           = log->NextSeq;
+            cursor->Page          = log->Head;
+            cursor->Location.Page = log->Head;
+            cursor->Offset        = E2PROMLOG_HEADER_SIZE;
+            cursor->End           = E2PROMLOG_HEADER_SIZE + log->Used;
+        } else {
+            return E2PROM_Null;
+        }
+    }
+    page = cursor->Staged ? log->PageBuffer : cursor->Buffer;
+    *len           = page[cursor->Offset];
+    cursor->Record = page + cursor->Offset + 1;
+    if (data != NULL) {
+        memcpy(data, cursor->Record, *len);
+    }
+    cursor->Location.Offset = cursor->Offset + 1;
+    cursor->Location.Len    = *len;
+    cursor->Offset += 1 + *len;
+    return E2PROM_Ok;
+}
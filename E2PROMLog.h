@@ -0,0 +1,118 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMLog.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief circular append-only record log on top of E2PROM
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+#ifndef _E2PROM_LOG_H_
+#define _E2PROM_LOG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "E2PROM.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief max time readers wait for flushed pages to be programmed before reading them back
+ */
+#define E2PROMLOG_SYNC_TIMEOUT          1000
+
+/**************************************************************************************************/
+
+
+
+/**
+ * @brief header at start of every log page, records are packed after it as [Len][Data...]
+ */
+typedef struct {
+    uint32_t Seq;   /**< sequence number of the page */
+    uint8_t  Used;  /**< bytes of records after the header */
+    uint8_t  Count; /**< number of records in the page */
+    uint16_t Crc;   /**< crc of Seq, Used, Count and records */
+} E2PROMLog_PageHeader;
+
+#define E2PROMLOG_HEADER_SIZE           sizeof(E2PROMLog_PageHeader)
+
+
+
+/**
+ * @brief Location of a record on the chip
+ */
+typedef struct {
+    uint16_t Page;   /**< page index inside the log region */
+    uint8_t  Offset; /**< offset of record data inside the page */
+    uint8_t  Len;    /**< length of record data */
+} E2PROMLog_Location;
+
+
+
+/**
+ * @brief Log main Struct
+ */
+typedef struct {
+    E2PROM*  Eeprom;
+    uint8_t* PageBuffer;   /**< staging page, PageSize bytes */
+    uint32_t NextSeq;
+    uint16_t StartAddress; /**< must be aligned to PageSize */
+    uint16_t Pages;
+    uint16_t Head;         /**< page index the staging page will be programmed to */
+    uint16_t Tail;         /**< oldest programmed page */
+    uint16_t Count;        /**< number of programmed pages */
+    uint8_t  Used;         /**< staged bytes after the header */
+    uint8_t  Records;      /**< staged records */
+    uint8_t  Unsynced;     /**< flushed pages may still be in the WriteStream */
+} E2PROMLog;
+
+
+
+/**
+ * @brief Cursor for iterate the log from oldest to newest record
+ */
+typedef struct {
+    uint8_t*           Buffer;    /**< PageSize bytes, holds the current page */
+    uint32_t           Seq;       /**< sequence number of current page */
+    const uint8_t*     Record;    /**< data of last record returned, valid until next call */
+    E2PROMLog_Location Location;  /**< location of last record returned */
+    uint16_t           Page;
+    uint16_t           Remaining; /**< programmed pages not visited yet */
+    uint8_t            Offset;
+    uint8_t            End;       /**< end of records in Buffer */
+    uint8_t            Staged     : 1; /**< cursor is on the staging page */
+    uint8_t            SkipStaged : 1; /**< stop after programmed pages */
+    uint8_t            Reserved   : 6;
+} E2PROMLog_Cursor;
+
+
+
+void          E2PROMLog_init(E2PROMLog* log, E2PROM* eeprom, uint16_t startAddress, uint16_t pages, uint8_t* pageBuffer);
+E2PROM_Result E2PROMLog_format(E2PROMLog* log);
+E2PROM_Result E2PROMLog_mount(E2PROMLog* log);
+E2PROM_Result E2PROMLog_append(E2PROMLog* log, const uint8_t* data, uint8_t len, E2PROMLog_Location* location);
+E2PROM_Result E2PROMLog_readAt(E2PROMLog* log, const E2PROMLog_Location* location, uint8_t* data);
+void          E2PROMLog_dropTail(E2PROMLog* log);
+E2PROM_Result E2PROMLog_flush(E2PROMLog* log);
+uint16_t      E2PROMLog_freePages(E2PROMLog* log);
+uint8_t       E2PROMLog_maxRecordLen(E2PROMLog* log);
+
+void          E2PROMLog_openCursor(E2PROMLog* log, E2PROMLog_Cursor* cursor, uint8_t* buffer);
+void          E2PROMLog_openTailCursor(E2PROMLog* log, E2PROMLog_Cursor* cursor, uint8_t* buffer);
+E2PROM_Result E2PROMLog_next(E2PROMLog* log, E2PROMLog_Cursor* cursor, uint8_t* data, uint8_t* len);
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_LOG_H_
@@ -0,0 +1,444 @@
+#include "E2PROMMirror.h"
+
+
+
+static E2PROMMirror* mirrors = (E2PROMMirror*)0;
+
+
+
+#define __other(D)              ((uint8_t)((D) ^ 1))
+
+
+
+/**
+ * @brief device has no command in queue or in process
+ *
+ * @param eeprom Address of E2PROM
+ * @return uint8_t
+ */
+static uint8_t E2PROMMirror_isIdle(E2PROM* eeprom) {
+    return Queue_available(&eeprom->CommandQueue) == 0 && eeprom->CommandHeaderInProcess.Len == 0 && !eeprom->InTransmit;
+}
+
+
+
+/**
+ * @brief number of commands device still has to do
+ *
+ * @param eeprom Address of E2PROM
+ * @return uint16_t
+ */
+static uint16_t E2PROMMirror_load(E2PROM* eeprom) {
+    return (uint16_t)Queue_available(&eeprom->CommandQueue) + (eeprom->CommandHeaderInProcess.Len > 0 ? 1 : 0);
+}
+
+
+
+/**
+ * @brief add a range to repair list, overlapped or touching ranges of same device are merged
+ *
+ * @param mirror Address of Mirror Struct
+ * @param device index of device must be repaired
+ * @param addr   Address of range
+ * @param len    Length of range
+ * @return uint8_t return 0 if list is full
+ */
+static uint8_t E2PROMMirror_addRepair(E2PROMMirror* mirror, uint8_t device, uint16_t addr, uint16_t len) {
+    E2PROMMirror_Range* range;
+    E2PROMMirror_Range* free = (E2PROMMirror_Range*)0;
+    uint32_t            end  = (uint32_t)addr + len;
+    for (uint8_t i = 0; i < E2PROMMIRROR_REPAIRS; i++) {
+        range = &mirror->Repairs[i];
+        if (range->Len == 0) {
+            if (free == (E2PROMMirror_Range*)0) {
+                free = range;
+            }
+        }
+        else if (range->Device == device && addr <= (uint32_t)range->Address + range->Len && end >= range->Address) {
+            if (end < (uint32_t)range->Address + range->Len) {
+                end = (uint32_t)range->Address + range->Len;
+            }
+            if (addr > range->Address) {
+                addr = range->Address;
+            }
+            range->Address = addr;
+            range->Len     = (uint16_t)(end - addr);
+            return 1;
+        }
+    }
+    if (free == (E2PROMMirror_Range*)0) {
+        return 0;
+    }
+    free->Address = addr;
+    free->Len     = len;
+    free->Device  = device;
+    return 1;
+}
+
+
+
+/**
+ * @brief find a read in a list and free its entry
+ *
+ * @param ranges Address of list
+ * @param count  number of entries
+ * @param device index of device
+ * @param addr   Address of read
+ * @param len    Length of read
+ * @return uint8_t return 0 if read is not in list
+ */
+static uint8_t E2PROMMirror_takeRead(E2PROMMirror_Range* ranges, uint8_t count, uint8_t device, uint16_t addr, uint16_t len) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (ranges[i].Len == len && ranges[i].Device == device && ranges[i].Address == addr) {
+            ranges[i].Len = 0;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+
+/**
+ * @brief onReadError of both devices, stream is ReadStream of the device that failed
+ *        a NonBlocking read of the mirror is moved to other device and range is marked for repair,
+ *        other reads of the devices only go to onReadError of the mirror
+ *
+ * @param stream ReadStream of device
+ * @param addr   Address of read
+ * @param len    Length of read
+ */
+static void E2PROMMirror_readErrorHandler(Stream* stream, uint16_t addr, uint16_t len) {
+    E2PROMMirror*       mirror = mirrors;
+    E2PROMMirror_Range* free   = (E2PROMMirror_Range*)0;
+    uint8_t             device = 0;
+    while (mirror != (E2PROMMirror*)0) {
+        if (stream == &mirror->Devices[0]->ReadStream) {
+            device = 0;
+            break;
+        }
+        if (stream == &mirror->Devices[1]->ReadStream) {
+            device = 1;
+            break;
+        }
+        mirror = mirror->Next;
+    }
+    if (mirror == (E2PROMMirror*)0 || mirror->InBlocking) {
+        return;
+    }
+    // blocking reads of the device are not in the lists, even if a queued read has same range
+    if (!mirror->Devices[device]->InBlocking &&
+        E2PROMMirror_takeRead(mirror->Reads, E2PROMMIRROR_READS, device, addr, len)) {
+        for (uint8_t i = 0; i < E2PROMMIRROR_FALLBACKS; i++) {
+            if (mirror->Fallbacks[i].Len == 0) {
+                free = &mirror->Fallbacks[i];
+                break;
+            }
+        }
+    }
+    // a fallback failed too, both copies are bad
+    else if (!mirror->Devices[device]->InBlocking) {
+        E2PROMMirror_takeRead(mirror->Fallbacks, E2PROMMIRROR_FALLBACKS, device, addr, len);
+    }
+    if (free != (E2PROMMirror_Range*)0 && E2PROM_read(mirror->Devices[__other(device)], addr, (uint8_t)len) == E2PROM_Ok) {
+        free->Address = addr;
+        free->Len     = len;
+        free->Device  = __other(device);
+        mirror->FallbackCount++;
+        E2PROMMirror_addRepair(mirror, device, addr, len);
+        return;
+    }
+    if (mirror->onReadError != NULL) {
+        mirror->onReadError(stream, addr, len);
+    }
+}
+
+
+
+/**
+ * @brief initial the Mirror, both devices must be added with E2PROM_add and have same onRead callback
+ *        onReadError of devices is used by the mirror, set E2PROMMirror_onReadError instead
+ *
+ * @param mirror Address of Mirror Struct
+ * @param first  Address of first E2PROM
+ * @param second Address of second E2PROM
+ * @return E2PROM_Result return E2PROM_HeaderValueError for a pooled device, mirror checks space of its own buffers
+ */
+E2PROM_Result E2PROMMirror_init(E2PROMMirror* mirror, E2PROM* first, E2PROM* second) {
+    E2PROMMirror* pMirror = mirrors;
+    if (first == E2PROM_NULL || second == E2PROM_NULL || first == second || !first->Configured || !second->Configured) {
+        return E2PROM_Null;
+    }
+#if E2PROM_USE_POOL
+    if (first->PoolQuota > 0 || second->PoolQuota > 0) {
+        return E2PROM_HeaderValueError;
+    }
+#endif
+    mirror->Devices[0]    = first;
+    mirror->Devices[1]    = second;
+    mirror->Size          = first->Config->Size < second->Config->Size ? first->Config->Size : second->Config->Size;
+    mirror->onReadError   = NULL;
+    mirror->FallbackCount = 0;
+    mirror->RepairCount   = 0;
+    mirror->NextRead      = 0;
+    mirror->InBlocking    = 0;
+    for (uint8_t i = 0; i < E2PROMMIRROR_READS; i++) {
+        mirror->Reads[i].Len = 0;
+    }
+    for (uint8_t i = 0; i < E2PROMMIRROR_FALLBACKS; i++) {
+        mirror->Fallbacks[i].Len = 0;
+    }
+    for (uint8_t i = 0; i < E2PROMMIRROR_REPAIRS; i++) {
+        mirror->Repairs[i].Len = 0;
+    }
+    E2PROM_onReadError(first, E2PROMMirror_readErrorHandler);
+    E2PROM_onReadError(second, E2PROMMirror_readErrorHandler);
+    // add Mirror to linked list
+    while (pMirror != (E2PROMMirror*)0 && pMirror != mirror) {
+        pMirror = pMirror->Next;
+    }
+    if (pMirror == (E2PROMMirror*)0) {
+        mirror->Next = mirrors;
+        mirrors      = mirror;
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief Callback Func, called when read of both copies failed
+ *
+ * @param mirror Address of Mirror Struct
+ * @param cb
+ */
+void E2PROMMirror_onReadError(E2PROMMirror* mirror, E2PROM_CallbackFn cb) {
+    mirror->onReadError = cb;
+}
+
+
+
+/**
+ * @brief NonBlocking write to both devices, they program in parallel in E2PROM_handle
+ *
+ * @param mirror Address of Mirror Struct
+ * @param addr   Address of E2PROM
+ * @param data   Address of Data
+ * @param len    Length of Data
+ * @return E2PROM_Result E2PROM_Busy if a device has not space, nothing is queued
+ */
+E2PROM_Result E2PROMMirror_write(E2PROMMirror* mirror, uint16_t addr, uint8_t* data, uint16_t len) {
+    E2PROM_Result result;
+    if (len == 0 || (uint32_t)addr + len > mirror->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        if (Queue_space(&mirror->Devices[i]->CommandQueue) == 0 || Stream_space(&mirror->Devices[i]->WriteStream) < len) {
+            return E2PROM_Busy;
+        }
+    }
+    result = E2PROM_write(mirror->Devices[0], addr, data, len, E2PROM_Variable);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    result = E2PROM_write(mirror->Devices[1], addr, data, len, E2PROM_Variable);
+    if (result != E2PROM_Ok) {
+        // first copy is queued, second one is copied from it later
+        E2PROMMirror_addRepair(mirror, 1, addr, len);
+    }
+    return result;
+}
+
+
+
+/**
+ * @brief NonBlocking read, data come to onRead of devices with their address
+ *        short reads go to less busy device, long reads are split on both
+ *
+ * @param mirror Address of Mirror Struct
+ * @param addr   Address of E2PROM
+ * @param len    Length of Data
+ * @return E2PROM_Result E2PROM_Busy if devices or list of reads have not space, nothing is queued
+ */
+E2PROM_Result E2PROMMirror_read(E2PROMMirror* mirror, uint16_t addr, uint16_t len) {
+    uint16_t loads[2];
+    uint16_t bytes[2]    = {0, 0};
+    uint16_t commands[2] = {0, 0};
+    uint16_t piece;
+    uint16_t pos;
+    uint8_t  device;
+    uint8_t  free = 0;
+    uint8_t  next = 0;
+    if (len == 0 || (uint32_t)addr + len > mirror->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    loads[0] = E2PROMMirror_load(mirror->Devices[0]);
+    loads[1] = E2PROMMirror_load(mirror->Devices[1]);
+    device   = loads[0] == loads[1] ? mirror->NextRead : (loads[0] < loads[1] ? 0 : 1);
+    piece    = len >= E2PROMMIRROR_SPLIT_LEN ? (len + 1) / 2 : len;
+    if (piece > 0xFF) {
+        piece = 0xFF;
+    }
+    // check space of both devices first
+    for (pos = 0; pos < len; pos += piece) {
+        bytes[device]    += (len - pos) < piece ? (len - pos) : piece;
+        commands[device] += 1;
+        device            = __other(device);
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        if (commands[i] > 0 &&
+            ((uint16_t)Queue_space(&mirror->Devices[i]->CommandQueue) < commands[i] ||
+             (uint16_t)Stream_space(&mirror->Devices[i]->ReadStream) < bytes[i])) {
+            return E2PROM_Busy;
+        }
+    }
+    for (uint8_t i = 0; i < E2PROMMIRROR_READS; i++) {
+        if (mirror->Reads[i].Len == 0) {
+            free++;
+        }
+    }
+    if (free < commands[0] + commands[1]) {
+        return E2PROM_Busy;
+    }
+    device = loads[0] == loads[1] ? mirror->NextRead : (loads[0] < loads[1] ? 0 : 1);
+    for (pos = 0; pos < len; pos += piece) {
+        while (mirror->Reads[next].Len > 0) {
+            next++;
+        }
+        mirror->Reads[next].Address = addr + pos;
+        mirror->Reads[next].Len     = (len - pos) < piece ? (len - pos) : piece;
+        mirror->Reads[next].Device  = device;
+        E2PROM_read(mirror->Devices[device], addr + pos, (uint8_t)mirror->Reads[next].Len);
+        device = __other(device);
+    }
+    mirror->NextRead = device;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief Blocking read from idle device, if it fails read other device and repair the first one
+ *        a device with NonBlocking commands is never read, its transfer would meet the blocking read
+ *
+ * @param mirror Address of Mirror Struct
+ * @param addr   Address of E2PROM
+ * @param buffer Address of buffer
+ * @param len    Length of Data
+ * @return E2PROM_Result E2PROM_Busy if no device is idle, or first device failed and other one is not idle, call again after E2PROM_handle
+ */
+E2PROM_Result E2PROMMirror_readBlocking(E2PROMMirror* mirror, uint16_t addr, uint8_t* buffer, uint16_t len) {
+    E2PROM_Result result;
+    uint8_t       device;
+    if (len == 0 || (uint32_t)addr + len > mirror->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    if (E2PROMMirror_isIdle(mirror->Devices[mirror->NextRead])) {
+        device = mirror->NextRead;
+    }
+    else if (E2PROMMirror_isIdle(mirror->Devices[__other(mirror->NextRead)])) {
+        device = __other(mirror->NextRead);
+    }
+    else {
+        return E2PROM_Busy;
+    }
+    mirror->NextRead   = __other(device);
+    mirror->InBlocking = 1;
+    result = E2PROM_readBlocking(mirror->Devices[device], addr, buffer, len);
+    if (result != E2PROM_Ok) {
+        if (!E2PROMMirror_isIdle(mirror->Devices[__other(device)])) {
+            // read again later, failed range is copied from other device when it is idle
+            E2PROMMirror_addRepair(mirror, device, addr, len);
+            mirror->InBlocking = 0;
+            return E2PROM_Busy;
+        }
+        result = E2PROM_readBlocking(mirror->Devices[__other(device)], addr, buffer, len);
+        if (result == E2PROM_Ok) {
+            mirror->FallbackCount++;
+            // data is in hand, repair now if source is still idle and device has space
+            if (E2PROMMirror_isIdle(mirror->Devices[__other(device)]) &&
+                Queue_space(&mirror->Devices[device]->CommandQueue) > 0 && Stream_space(&mirror->Devices[device]->WriteStream) >= len &&
+                E2PROM_write(mirror->Devices[device], addr, buffer, len, E2PROM_Variable) == E2PROM_Ok) {
+                mirror->RepairCount++;
+            }
+            else {
+                E2PROMMirror_addRepair(mirror, device, addr, len);
+            }
+        }
+    }
+    mirror->InBlocking = 0;
+    return result;
+}
+
+
+
+/**
+ * @brief must be called in while(1), forget finished reads and fallbacks and copy repair ranges from good device
+ *
+ * @param mirror Address of Mirror Struct
+ */
+void E2PROMMirror_process(E2PROMMirror* mirror) {
+    E2PROMMirror_Range* range;
+    uint8_t             buffer[E2PROMMIRROR_REPAIR_CHUNK];
+    uint16_t            len;
+    E2PROM*             source;
+    E2PROM*             target;
+    for (uint8_t i = 0; i < E2PROMMIRROR_READS; i++) {
+        range = &mirror->Reads[i];
+        if (range->Len > 0 && E2PROMMirror_isIdle(mirror->Devices[range->Device])) {
+            range->Len = 0;
+        }
+    }
+    for (uint8_t i = 0; i < E2PROMMIRROR_FALLBACKS; i++) {
+        range = &mirror->Fallbacks[i];
+        if (range->Len > 0 && E2PROMMirror_isIdle(mirror->Devices[range->Device])) {
+            range->Len = 0;
+        }
+    }
+    for (uint8_t i = 0; i < E2PROMMIRROR_REPAIRS; i++) {
+        range = &mirror->Repairs[i];
+        if (range->Len == 0) {
+            continue;
+        }
+        target = mirror->Devices[range->Device];
+        source = mirror->Devices[__other(range->Device)];
+        len    = range->Len < E2PROMMIRROR_REPAIR_CHUNK ? range->Len : E2PROMMIRROR_REPAIR_CHUNK;
+        // blocking read of source must not meet its NonBlocking commands
+        if (!E2PROMMirror_isIdle(source) || Queue_space(&target->CommandQueue) == 0 || Stream_space(&target->WriteStream) < len) {
+            continue;
+        }
+        mirror->InBlocking = 1;
+        if (E2PROM_readBlocking(source, range->Address, buffer, len) == E2PROM_Ok) {
+            E2PROM_write(target, range->Address, buffer, len, E2PROM_Variable);
+            range->Address += len;
+            range->Len     -= len;
+            if (range->Len == 0) {
+                mirror->RepairCount++;
+            }
+        }
+        else {
+            // both copies are bad, nothing to copy
+            range->Len = 0;
+        }
+        mirror->InBlocking = 0;
+        return;
+    }
+}
+
+
+
+/**
+ * @brief number of ranges wait for repair
+ *
+ * @param mirror Address of Mirror Struct
+ * @return uint8_t
+ */
+uint8_t E2PROMMirror_repairPending(E2PROMMirror* mirror) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < E2PROMMIRROR_REPAIRS; i++) {
+        if (mirror->Repairs[i].Len > 0) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,99 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMMirror.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief two E2PROM devices with same data, reads are balanced between them and fall back on error
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+#ifndef _E2PROM_MIRROR_H_
+#define _E2PROM_MIRROR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "E2PROM.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief NonBlocking reads of this length or more are split on both devices
+ */
+#define E2PROMMIRROR_SPLIT_LEN          32
+
+/**
+ * @brief max NonBlocking reads of E2PROMMirror_read in progress, only these are moved to other device on error
+ */
+#define E2PROMMIRROR_READS              8
+
+/**
+ * @brief max reads moved to other device at same time
+ */
+#define E2PROMMIRROR_FALLBACKS          4
+
+/**
+ * @brief max ranges wait for repair
+ */
+#define E2PROMMIRROR_REPAIRS            4
+
+/**
+ * @brief bytes copied in each repair step
+ */
+#define E2PROMMIRROR_REPAIR_CHUNK       32
+
+/**************************************************************************************************/
+
+
+
+/**
+ * @brief a range of addresses on one device of the mirror, Len 0 is a free entry
+ */
+typedef struct {
+    uint16_t Address;
+    uint16_t Len;
+    uint8_t  Device;
+} E2PROMMirror_Range;
+
+
+
+/**
+ * @brief Mirror main Struct
+ */
+typedef struct __E2PROMMirror {
+    struct __E2PROMMirror* Next;
+    E2PROM*                Devices[2];
+    E2PROM_CallbackFn      onReadError;   /**< read of both copies failed */
+    E2PROMMirror_Range     Reads[E2PROMMIRROR_READS];         /**< NonBlocking reads queued on Device by the mirror */
+    E2PROMMirror_Range     Fallbacks[E2PROMMIRROR_FALLBACKS]; /**< reads moved to Device after an error */
+    E2PROMMirror_Range     Repairs[E2PROMMIRROR_REPAIRS];     /**< ranges of Device must be copied from other device */
+    uint32_t               FallbackCount;
+    uint32_t               RepairCount;
+    uint16_t               Size;
+    uint8_t                NextRead;
+    uint8_t                InBlocking;
+} E2PROMMirror;
+
+
+
+E2PROM_Result E2PROMMirror_init(E2PROMMirror* mirror, E2PROM* first, E2PROM* second);
+void          E2PROMMirror_onReadError(E2PROMMirror* mirror, E2PROM_CallbackFn cb);
+E2PROM_Result E2PROMMirror_write(E2PROMMirror* mirror, uint16_t addr, uint8_t* data, uint16_t len);
+E2PROM_Result E2PROMMirror_read(E2PROMMirror* mirror, uint16_t addr, uint16_t len);
+E2PROM_Result E2PROMMirror_readBlocking(E2PROMMirror* mirror, uint16_t addr, uint8_t* buffer, uint16_t len);
+void          E2PROMMirror_process(E2PROMMirror* mirror);
+uint8_t       E2PROMMirror_repairPending(E2PROMMirror* mirror);
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_MIRROR_H_
@@ -0,0 +1,247 @@
+#include "E2PROMRecord.h"
+#include "E2PROMCrc.h"
+
+#include <string.h>
+
+
+
+/**
+ * @brief copy value and its crc to buffer
+ *
+ * @param buffer Address of buffer of E2PROMRECORD_SIZE(len)
+ * @param data   Address of value
+ * @param len    Length of value
+ */
+static void E2PROMRecord_build(uint8_t* buffer, const void* data, uint16_t len) {
+    uint16_t crc = E2PROMCrc_calc((const uint8_t*)data, len);
+    memcpy(buffer, data, len);
+    memcpy(&buffer[len], &crc, E2PROMRECORD_CRC_SIZE);
+}
+
+
+
+/**
+ * @brief NonBlocking write of value and its crc, with one command
+ *
+ * @param eeprom Address of E2PROM
+ * @param addr   Address of record on chip
+ * @param data   Address of value, it is copied
+ * @param len    Length of value, max E2PROMRECORD_MAX_LEN
+ * @return E2PROM_Result E2PROM_Busy if E2PROM can not take it now
+ */
+E2PROM_Result E2PROMRecord_write(E2PROM* eeprom, uint16_t addr, const void* data, uint16_t len) {
+    uint8_t buffer[E2PROMRECORD_SIZE(E2PROMRECORD_MAX_LEN)];
+    if (len > E2PROMRECORD_MAX_LEN || (uint32_t)addr + E2PROMRECORD_SIZE(len) > eeprom->Config->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    E2PROMRecord_build(buffer, data, len);
+    return E2PROM_write(eeprom, addr, buffer, E2PROMRECORD_SIZE(len), E2PROM_Variable);
+}
+
+
+
+/**
+ * @brief Blocking write of value and its crc
+ *
+ * @param eeprom Address of E2PROM
+ * @param addr   Address of record on chip
+ * @param data   Address of value
+ * @param len    Length of value, max E2PROMRECORD_MAX_LEN
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMRecord_writeBlocking(E2PROM* eeprom, uint16_t addr, const void* data, uint16_t len) {
+    uint8_t buffer[E2PROMRECORD_SIZE(E2PROMRECORD_MAX_LEN)];
+    if (len > E2PROMRECORD_MAX_LEN || (uint32_t)addr + E2PROMRECORD_SIZE(len) > eeprom->Config->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    E2PROMRecord_build(buffer, data, len);
+    return E2PROM_writeBlocking(eeprom, addr, buffer, E2PROMRECORD_SIZE(len));
+}
+
+
+
+/**
+ * @brief Blocking read of a record, crc is checked while it is read
+ *
+ * @param eeprom Address of E2PROM
+ * @param addr   Address of record on chip
+ * @param data   Address of buffer of value
+ * @param len    Length of value
+ * @return E2PROM_Result E2PROM_Error if crc is not same
+ */
+E2PROM_Result E2PROMRecord_readBlocking(E2PROM* eeprom, uint16_t addr, void* data, uint16_t len) {
+    E2PROMRecord record;
+    uint32_t     bad;
+    record.Address = addr;
+    record.Len     = len;
+    record.Value   = data;
+    return E2PROMRecord_load(eeprom, &record, 1, &bad);
+}
+
+
+
+/**
+ * @brief NonBlocking read of a record, in onRead give the stream to E2PROMRecord_readStream
+ *
+ * @param eeprom Address of E2PROM
+ * @param addr   Address of record on chip
+ * @param len    Length of value
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMRecord_read(E2PROM* eeprom, uint16_t addr, uint8_t len) {
+    if (len > UINT8_MAX - E2PROMRECORD_CRC_SIZE) {
+        return E2PROM_HeaderValueError;
+    }
+    return E2PROM_read(eeprom, addr, E2PROMRECORD_SIZE(len));
+}
+
+
+
+/**
+ * @brief take a record from stream of onRead and check its crc
+ *
+ * @param stream stream of onRead
+ * @param data   Address of buffer of value
+ * @param len    Length of value
+ * @return E2PROM_Result E2PROM_Error if crc is not same
+ */
+E2PROM_Result E2PROMRecord_readStream(Stream* stream, void* data, uint16_t len) {
+    uint16_t crc;
+    if (Stream_available(stream) < E2PROMRECORD_SIZE(len)) {
+        return E2PROM_HeaderValueError;
+    }
+    Stream_readBytes(stream, (uint8_t*)data, len);
+    Stream_readBytes(stream, (uint8_t*)&crc, E2PROMRECORD_CRC_SIZE);
+    return E2PROMCrc_calc((const uint8_t*)data, len) == crc ? E2PROM_Ok : E2PROM_Error;
+}
+
+
+
+/**
+ * @brief Blocking load of a table of records in one pass, records next to each other are read in same chunks
+ *        and crc of each record is calculated while its chunks come, so they are not read again for check
+ *
+ * @param eeprom     Address of E2PROM
+ * @param records    table of records, sorted by Address and not overlapped
+ * @param count      number of records
+ * @param badRecords bit of each record that its crc is not same, for first 32 records
+ * @return E2PROM_Result E2PROM_Error if a record is bad, values of bad records are not valid
+ */
+E2PROM_Result E2PROMRecord_load(E2PROM* eeprom, const E2PROMRecord* records, uint8_t count, uint32_t* badRecords) {
+    uint8_t       chunk[E2PROMRECORD_CHUNK_SIZE];
+    uint16_t      stored;
+    uint16_t      crc    = E2PROM_CRC_INIT;
+    uint16_t      offset = 0;     /**< position in records[i] */
+    uint32_t      addr   = 0;
+    uint32_t      runEnd = 0;     /**< end of records next to each other */
+    uint16_t      len;
+    uint16_t      pos;
+    uint16_t      part;
+    uint8_t       i      = 0;
+    uint8_t       j;
+    E2PROM_Result result = E2PROM_Ok;
+    *badRecords = 0;
+    for (j = 0; j < count; j++) {
+        if ((uint32_t)records[j].Address + E2PROMRECORD_SIZE(records[j].Len) > eeprom->Config->Size ||
+            (j > 0 && records[j].Address < (uint32_t)records[j - 1].Address + E2PROMRECORD_SIZE(records[j - 1].Len))) {
+            return E2PROM_HeaderValueError;
+        }
+    }
+    while (i < count) {
+        if (addr >= runEnd) {
+            // skip gap to next record
+            addr   = records[i].Address;
+            runEnd = addr + E2PROMRECORD_SIZE(records[i].Len);
+            for (j = i + 1; j < count && records[j].Address == runEnd; j++) {
+                runEnd += E2PROMRECORD_SIZE(records[j].Len);
+            }
+        }
+        len    = runEnd - addr > E2PROMRECORD_CHUNK_SIZE ? E2PROMRECORD_CHUNK_SIZE : (uint16_t)(runEnd - addr);
+        result = E2PROM_readBlocking(eeprom, (uint16_t)addr, chunk, len);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+        addr += len;
+        pos   = 0;
+        while (pos < len) {
+            if (offset < records[i].Len) {
+                part = records[i].Len - offset > len - pos ? len - pos : records[i].Len - offset;
+                memcpy((uint8_t*)records[i].Value + offset, &chunk[pos], part);
+                crc  = E2PROMCrc_update(crc, &chunk[pos], part);
+            } else {
+                part = E2PROMRECORD_SIZE(records[i].Len) - offset > len - pos ? len - pos : E2PROMRECORD_SIZE(records[i].Len) - offset;
+                memcpy((uint8_t*)&stored + (offset - records[i].Len), &chunk[pos], part);
+            }
+            pos    += part;
+            offset += part;
+            if (offset == E2PROMRECORD_SIZE(records[i].Len)) {
+                if (stored != crc) {
+                    if (i < 32) {
+                        *badRecords |= 1UL << i;
+                    }
+                    result = E2PROM_Error;
+                }
+                i++;
+                offset = 0;
+                crc    = E2PROM_CRC_INIT;
+            }
+        }
+    }
+    return *badRecords != 0 ? E2PROM_Error : result;
+}
+
+
+
+/**
+ * @brief NonBlocking write of a record of table with its Value
+ *
+ * @param eeprom Address of E2PROM
+ * @param record Address of record
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMRecord_store(E2PROM* eeprom, const E2PROMRecord* record) {
+    return E2PROMRecord_write(eeprom, record->Address, record->Value, record->Len);
+}
+
+
+
+E2PROM_Result E2PROMRecord_writeUInt8(E2PROM* eeprom, uint8_t val, uint16_t addr) {
+    return E2PROMRecord_write(eeprom, addr, &val, sizeof(val));
+}
+E2PROM_Result E2PROMRecord_writeUInt16(E2PROM* eeprom, uint16_t val, uint16_t addr) {
+    return E2PROMRecord_write(eeprom, addr, &val, sizeof(val));
+}
+E2PROM_Result E2PROMRecord_writeUInt32(E2PROM* eeprom, uint32_t val, uint16_t addr) {
+    return E2PROMRecord_write(eeprom, addr, &val, sizeof(val));
+}
+E2PROM_Result E2PROMRecord_writeUInt64(E2PROM* eeprom, uint64_t val, uint16_t addr) {
+    return E2PROMRecord_write(eeprom, addr, &val, sizeof(val));
+}
+
+
+E2PROM_Result E2PROMRecord_writeUInt8Blocking(E2PROM* eeprom, uint8_t val, uint16_t addr) {
+    return E2PROMRecord_writeBlocking(eeprom, addr, &val, sizeof(val));
+}
+E2PROM_Result E2PROMRecord_writeUInt16Blocking(E2PROM* eeprom, uint16_t val, uint16_t addr) {
+    return E2PROMRecord_writeBlocking(eeprom, addr, &val, sizeof(val));
+}
+E2PROM_Result E2PROMRecord_writeUInt32Blocking(E2PROM* eeprom, uint32_t val, uint16_t addr) {
+    return E2PROMRecord_writeBlocking(eeprom, addr, &val, sizeof(val));
+}
+E2PROM_Result E2PROMRecord_writeUInt64Blocking(E2PROM* eeprom, uint64_t val, uint16_t addr) {
+    return E2PROMRecord_writeBlocking(eeprom, addr, &val, sizeof(val));
+}
+
+
+E2PROM_Result E2PROMRecord_readUInt8Blocking(E2PROM* eeprom, uint16_t addr, uint8_t* val) {
+    return E2PROMRecord_readBlocking(eeprom, addr, val, sizeof(*val));
+}
+E2PROM_Result E2PROMRecord_readUInt16Blocking(E2PROM* eeprom, uint16_t addr, uint16_t* val) {
+    return E2PROMRecord_readBlocking(eeprom, addr, val, sizeof(*val));
+}
+E2PROM_Result E2PROMRecord_readUInt32Blocking(E2PROM* eeprom, uint16_t addr, uint32_t* val) {
+    return E2PROMRecord_readBlocking(eeprom, addr, val, sizeof(*val));
+}
+E2PROM_Result E2PROMRecord_readUInt64Blocking(E2PROM* eeprom, uint16_t addr, uint64_t* val) {
+    return E2PROMRecord_readBlocking(eeprom, addr, val, sizeof(*val));
+}
@@ -0,0 +1,88 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMRecord.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief typed and struct records with CRC on E2PROM, on chip each record is value then 2 bytes crc
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+#ifndef _E2PROM_RECORD_H_
+#define _E2PROM_RECORD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "E2PROM.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief max length of value of write functions, value and crc are copied to a buffer on stack
+ */
+#define E2PROMRECORD_MAX_LEN            64
+
+/**
+ * @brief size of chunk buffer of load, for less bus transfers set it >= PageSize
+ */
+#define E2PROMRECORD_CHUNK_SIZE         32
+
+/**************************************************************************************************/
+
+#define E2PROMRECORD_CRC_SIZE           2
+/**
+ * @brief size of record on chip
+ */
+#define E2PROMRECORD_SIZE(LEN)          ((LEN) + E2PROMRECORD_CRC_SIZE)
+
+
+
+/**
+ * @brief a record of table of E2PROMRecord_load
+ */
+typedef struct {
+    uint16_t Address;   /**< address of record on chip */
+    uint16_t Len;       /**< length of value without crc */
+    void*    Value;     /**< value in RAM */
+} E2PROMRecord;
+
+
+
+E2PROM_Result E2PROMRecord_write(E2PROM* eeprom, uint16_t addr, const void* data, uint16_t len);
+E2PROM_Result E2PROMRecord_writeBlocking(E2PROM* eeprom, uint16_t addr, const void* data, uint16_t len);
+E2PROM_Result E2PROMRecord_readBlocking(E2PROM* eeprom, uint16_t addr, void* data, uint16_t len);
+
+E2PROM_Result E2PROMRecord_read(E2PROM* eeprom, uint16_t addr, uint8_t len);
+E2PROM_Result E2PROMRecord_readStream(Stream* stream, void* data, uint16_t len);
+
+E2PROM_Result E2PROMRecord_load(E2PROM* eeprom, const E2PROMRecord* records, uint8_t count, uint32_t* badRecords);
+E2PROM_Result E2PROMRecord_store(E2PROM* eeprom, const E2PROMRecord* record);
+
+E2PROM_Result E2PROMRecord_writeUInt8(E2PROM* eeprom, uint8_t val, uint16_t addr);
+E2PROM_Result E2PROMRecord_writeUInt16(E2PROM* eeprom, uint16_t val, uint16_t addr);
+E2PROM_Result E2PROMRecord_writeUInt32(E2PROM* eeprom, uint32_t val, uint16_t addr);
+E2PROM_Result E2PROMRecord_writeUInt64(E2PROM* eeprom, uint64_t val, uint16_t addr);
+
+E2PROM_Result E2PROMRecord_writeUInt8Blocking(E2PROM* eeprom, uint8_t val, uint16_t addr);
+E2PROM_Result E2PROMRecord_writeUInt16Blocking(E2PROM* eeprom, uint16_t val, uint16_t addr);
+E2PROM_Result E2PROMRecord_writeUInt32Blocking(E2PROM* eeprom, uint32_t val, uint16_t addr);
+E2PROM_Result E2PROMRecord_writeUInt64Blocking(E2PROM* eeprom, uint64_t val, uint16_t addr);
+
+E2PROM_Result E2PROMRecord_readUInt8Blocking(E2PROM* eeprom, uint16_t addr, uint8_t* val);
+E2PROM_Result E2PROMRecord_readUInt16Blocking(E2PROM* eeprom, uint16_t addr, uint16_t* val);
+E2PROM_Result E2PROMRecord_readUInt32Blocking(E2PROM* eeprom, uint16_t addr, uint32_t* val);
+E2PROM_Result E2PROMRecord_readUInt64Blocking(E2PROM* eeprom, uint16_t addr, uint64_t* val);
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_RECORD_H_
@@ -0,0 +1,300 @@
+#include "E2PROMTxn.h"
+#include "E2PROMCrc.h"
+
+#include <string.h>
+
+
+
+#define __pageSize(TXN)             ((TXN)->Eeprom->Config->PageSize)
+#define __slotPages(TXN)            (((TXN)->Size + __pageSize(TXN) - 1) / __pageSize(TXN))
+#define __commitAddress(TXN, SLOT)  ((uint16_t)((TXN)->BaseAddress + (SLOT) * sizeof(E2PROMTxn_Commit)))
+#define __slotAddress(TXN, SLOT)    ((uint16_t)((TXN)->BaseAddress + __pageSize(TXN) * (1 + (SLOT) * __slotPages(TXN))))
+#define __pageMask(TXN, ADDR)       ((E2PROMTxn_PageMask)1 << ((ADDR) / __pageSize(TXN)))
+
+
+
+/**
+ * @brief initial the Transaction, data hold the struct and after mount hold last committed copy
+ *
+ * @param txn         Address of Transaction Struct
+ * @param eeprom      Address of E2PROM
+ * @param baseAddress first address of region, aligned to PageSize
+ * @param data        Address of struct in RAM
+ * @param size        sizeof struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMTxn_init(E2PROMTxn* txn, E2PROM* eeprom, uint16_t baseAddress, void* data, uint16_t size) {
+    txn->Eeprom        = eeprom;
+    txn->Data          = (uint8_t*)data;
+    txn->BaseAddress   = baseAddress;
+    txn->Size          = size;
+    txn->Dirty         = 0;
+    txn->Stale         = 0;
+    txn->Seq           = 0;
+    txn->Active        = 1;
+    txn->Committed     = 0;
+    txn->InTransaction = 0;
+    if (size == 0 ||
+        __pageSize(txn) < 2 * sizeof(E2PROMTxn_Commit) ||
+        (baseAddress % __pageSize(txn)) != 0 ||
+        (uint32_t)__slotPages(txn) > E2PROMTXN_MAX_PAGES ||
+        (uint32_t)baseAddress + E2PROMTxn_regionSize(txn) > eeprom->Config->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    txn->Stale = ~(E2PROMTxn_PageMask)0;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief size of region use by the Transaction, one page for commit records and two slots
+ *
+ * @param txn Address of Transaction Struct
+ * @return uint16_t
+ */
+uint16_t E2PROMTxn_regionSize(E2PROMTxn* txn) {
+    return __pageSize(txn) * (1 + 2 * __slotPages(txn));
+}
+
+
+
+/**
+ * @brief crc of a slot on the chip, read in chunks
+ *
+ * @param txn  Address of Transaction Struct
+ * @param slot
+ * @param crc  crc of slot data
+ * @return E2PROM_Result
+ */
+static E2PROM_Result E2PROMTxn_slotCrc(E2PROMTxn* txn, uint8_t slot, uint16_t* crc) {
+    uint8_t       chunk[E2PROMTXN_CHUNK_SIZE];
+    uint16_t      len;
+    E2PROM_Result result;
+    *crc = E2PROM_CRC_INIT;
+    for (uint16_t offset = 0; offset < txn->Size; offset += len) {
+        len    = (txn->Size - offset) > E2PROMTXN_CHUNK_SIZE ? E2PROMTXN_CHUNK_SIZE : (txn->Size - offset);
+        result = E2PROM_readBlocking(txn->Eeprom, __slotAddress(txn, slot) + offset, chunk, len);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+        *crc = E2PROMCrc_update(*crc, chunk, len);
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief pages of a slot on the chip differ from Data, read in chunks
+ *
+ * @param txn  Address of Transaction Struct
+ * @param slot
+ * @return E2PROMTxn_PageMask
+ */
+static E2PROMTxn_PageMask E2PROMTxn_diff(E2PROMTxn* txn, uint8_t slot) {
+    uint8_t            chunk[E2PROMTXN_CHUNK_SIZE];
+    uint16_t           len;
+    E2PROMTxn_PageMask mask = 0;
+    for (uint16_t offset = 0; offset < txn->Size; offset += len) {
+        len = (txn->Size - offset) > E2PROMTXN_CHUNK_SIZE ? E2PROMTXN_CHUNK_SIZE : (txn->Size - offset);
+        // chunk must not cross a page
+        if (len > __pageSize(txn) - (offset % __pageSize(txn))) {
+            len = __pageSize(txn) - (offset % __pageSize(txn));
+        }
+        if (E2PROM_readBlocking(txn->Eeprom, __slotAddress(txn, slot) + offset, chunk, len) != E2PROM_Ok ||
+            E2PROM_assertMemory(chunk, txn->Data + offset, len) != 0) {
+            mask |= __pageMask(txn, offset);
+        }
+    }
+    return mask;
+}
+
+
+
+/**
+ * @brief load last valid committed copy into Data, Blocking
+ *
+ * @param txn Address of Transaction Struct
+ * @return E2PROM_Result return E2PROM_Null if no valid copy exists and Data not changed
+ */
+E2PROM_Result E2PROMTxn_mount(E2PROMTxn* txn) {
+    E2PROMTxn_Commit commits[2];
+    uint8_t          valid[2];
+    uint16_t         crc;
+    uint8_t          slot;
+    E2PROM_Result    result;
+
+    txn->Dirty         = 0;
+    txn->Stale         = ~(E2PROMTxn_PageMask)0;
+    txn->Seq           = 0;
+    txn->Active        = 1;
+    txn->Committed     = 0;
+    txn->InTransaction = 0;
+
+    result = E2PROM_readBlocking(txn->Eeprom, __commitAddress(txn, 0), (uint8_t*)commits, sizeof(commits));
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    for (slot = 0; slot < 2; slot++) {
+        valid[slot] = 0;
+        if ((commits[slot].Seq ^ commits[slot].SeqInv) == 0xFF &&
+            E2PROMTxn_slotCrc(txn, slot, &crc) == E2PROM_Ok &&
+            E2PROMCrc_update(crc, &commits[slot].Seq, 1) == commits[slot].Crc) {
+            valid[slot] = 1;
+        }
+    }
+    if (!valid[0] && !valid[1]) {
+        return E2PROM_Null;
+    }
+    if (valid[0] && valid[1]) {
+        slot = (int8_t)(commits[1].Seq - commits[0].Seq) > 0 ? 1 : 0;
+    } else {
+        slot = valid[1];
+    }
+    result = E2PROM_readBlocking(txn->Eeprom, __slotAddress(txn, slot), txn->Data, txn->Size);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    txn->Active    = slot;
+    txn->Seq       = commits[slot].Seq;
+    txn->Committed = 1;
+    if (valid[!slot]) {
+        txn->Stale = E2PROMTxn_diff(txn, !slot);
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief start a Transaction
+ *
+ * @param txn Address of Transaction Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMTxn_begin(E2PROMTxn* txn) {
+    if (txn->InTransaction) {
+        return E2PROM_Busy;
+    }
+    txn->InTransaction = 1;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief mark a part of Data changed, when u change Data directly
+ *
+ * @param txn    Address of Transaction Struct
+ * @param offset offset in struct
+ * @param len    length of change
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMTxn_markDirty(E2PROMTxn* txn, uint16_t offset, uint16_t len) {
+    if (!txn->InTransaction) {
+        return E2PROM_Error;
+    }
+    if (len == 0 || (uint32_t)offset + len > txn->Size) {
+        return E2PROM_HeaderValueError;
+    }
+    for (uint16_t addr = offset - (offset % __pageSize(txn)); addr < offset + len; addr += __pageSize(txn)) {
+        txn->Dirty |= __pageMask(txn, addr);
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief copy new value of a field into Data
+ *
+ * @param txn    Address of Transaction Struct
+ * @param offset offset in struct, e.g. offsetof
+ * @param data   Address of new value
+ * @param len    Length of new value
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMTxn_stage(E2PROMTxn* txn, uint16_t offset, const void* data, uint16_t len) {
+    E2PROM_Result result = E2PROMTxn_markDirty(txn, offset, len);
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    memcpy(txn->Data + offset, data, len);
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief program Data into inactive slot and then its commit record, Blocking
+ *        only pages changed in this Transaction or in previous one are programmed
+ *        on error Transaction stay open and commit can try again
+ *
+ * @param txn Address of Transaction Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMTxn_commit(E2PROMTxn* txn) {
+    E2PROMTxn_Commit   commit;
+    E2PROMTxn_PageMask pages  = txn->Dirty | txn->Stale;
+    uint8_t            target = !txn->Active;
+    uint16_t           len;
+    E2PROM_Result      result;
+    if (!txn->InTransaction) {
+        return E2PROM_Error;
+    }
+    // pages of target slot are changed from here, if commit fails they must be programmed again by next commit
+    txn->Stale |= pages;
+    for (uint16_t offset = 0; offset < txn->Size; offset += __pageSize(txn)) {
+        if (pages & __pageMask(txn, offset)) {
+            len    = (txn->Size - offset) > __pageSize(txn) ? __pageSize(txn) : (txn->Size - offset);
+            result = E2PROM_writeBlocking(txn->Eeprom, __slotAddress(txn, target) + offset, txn->Data + offset, len);
+            if (result != E2PROM_Ok) {
+                return result;
+            }
+        }
+    }
+    commit.Seq    = txn->Seq + 1;
+    commit.SeqInv = ~commit.Seq;
+    commit.Crc    = E2PROMCrc_update(E2PROMCrc_calc(txn->Data, txn->Size), &commit.Seq, 1);
+    result = E2PROM_writeBlocking(txn->Eeprom, __commitAddress(txn, target), &commit, sizeof(commit));
+    if (result != E2PROM_Ok) {
+        return result;
+    }
+    // previous slot lacks only changes of this Transaction, or everything if it was never committed
+    txn->Stale         = txn->Committed ? txn->Dirty : ~(E2PROMTxn_PageMask)0;
+    txn->Active        = target;
+    txn->Seq           = commit.Seq;
+    txn->Committed     = 1;
+    txn->Dirty         = 0;
+    txn->InTransaction = 0;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief drop staged changes, dirty pages of Data read again from active slot, Blocking
+ *
+ * @param txn Address of Transaction Struct
+ * @return E2PROM_Result
+ */
+E2PROM_Result E2PROMTxn_abort(E2PROMTxn* txn) {
+    uint16_t      len;
+    E2PROM_Result result;
+    if (!txn->InTransaction) {
+        return E2PROM_Error;
+    }
+    for (uint16_t offset = 0; offset < txn->Size; offset += __pageSize(txn)) {
+        if (txn->Dirty & __pageMask(txn, offset)) {
+            len    = (txn->Size - offset) > __pageSize(txn) ? __pageSize(txn) : (txn->Size - offset);
+            result = E2PROM_readBlocking(txn->Eeprom, __slotAddress(txn, txn->Active) + offset, txn->Data + offset, len);
+            if (result != E2PROM_Ok) {
+                return result;
+            }
+        }
+    }
+    txn->Dirty         = 0;
+    txn->InTransaction = 0;
+    return E2PROM_Ok;
+}
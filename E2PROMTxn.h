@@ -0,0 +1,89 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMTxn.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief power-fail safe A/B transactions for structs that span pages
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+#ifndef _E2PROM_TXN_H_
+#define _E2PROM_TXN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "E2PROM.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief size of chunks use for compare and crc of slots at mount
+ */
+#define E2PROMTXN_CHUNK_SIZE            16
+
+/**************************************************************************************************/
+
+
+
+/**
+ * @brief Page Mask Type, one bit for each page of a slot
+ */
+typedef uint32_t E2PROMTxn_PageMask;
+
+#define E2PROMTXN_MAX_PAGES             (sizeof(E2PROMTxn_PageMask) * 8)
+
+
+
+/**
+ * @brief commit record of a slot, written after data pages of that slot
+ */
+typedef struct {
+    uint8_t  Seq;
+    uint8_t  SeqInv; /**< ~Seq */
+    uint16_t Crc;    /**< crc of slot data and Seq */
+} E2PROMTxn_Commit;
+
+
+
+/**
+ * @brief Transaction main Struct
+ *        layout: [commit A][commit B] in first page, then slot A and slot B
+ */
+typedef struct {
+    E2PROM*            Eeprom;
+    uint8_t*           Data;          /**< RAM image of struct */
+    E2PROMTxn_PageMask Dirty;         /**< pages staged since last commit */
+    E2PROMTxn_PageMask Stale;         /**< pages of inactive slot differ from last commit */
+    uint16_t           BaseAddress;   /**< aligned to PageSize */
+    uint16_t           Size;          /**< size of struct */
+    uint8_t            Seq;           /**< sequence of active copy */
+    uint8_t            Active;        /**< active slot, 0 or 1 */
+    uint8_t            Committed;     /**< active slot holds a valid copy */
+    uint8_t            InTransaction;
+} E2PROMTxn;
+
+
+
+E2PROM_Result E2PROMTxn_init(E2PROMTxn* txn, E2PROM* eeprom, uint16_t baseAddress, void* data, uint16_t size);
+uint16_t      E2PROMTxn_regionSize(E2PROMTxn* txn);
+E2PROM_Result E2PROMTxn_mount(E2PROMTxn* txn);
+E2PROM_Result E2PROMTxn_begin(E2PROMTxn* txn);
+E2PROM_Result E2PROMTxn_stage(E2PROMTxn* txn, uint16_t offset, const void* data, uint16_t len);
+E2PROM_Result E2PROMTxn_markDirty(E2PROMTxn* txn, uint16_t offset, uint16_t len);
+E2PROM_Result E2PROMTxn_commit(E2PROMTxn* txn);
+E2PROM_Result E2PROMTxn_abort(E2PROMTxn* txn);
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_TXN_H_
@@ -0,0 +1,160 @@
+#include "E2PROMVolume.h"
+
+
+
+/**
+ * @brief initial the Volume, size of volume is limited by smallest device
+ *
+ * @param volume     Address of Volume Struct
+ * @param devices    array of devices, must be valid while volume is used
+ * @param count      number of devices
+ * @param stripeSize bytes of each stripe
+ * @return E2PROM_Result return E2PROM_HeaderValueError for a pooled device, write checks space of its own buffers
+ */
+E2PROM_Result E2PROMVolume_init(E2PROMVolume* volume, E2PROM** devices, uint8_t count, uint16_t stripeSize) {
+    uint16_t minSize = 0xFFFF;
+    if (devices == (E2PROM**)0 || count == 0 || count > E2PROMVOLUME_MAX_DEVICES || stripeSize == 0) {
+        return E2PROM_HeaderValueError;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (devices[i] == E2PROM_NULL || !devices[i]->Configured) {
+            return E2PROM_Null;
+        }
+#if E2PROM_USE_POOL
+        if (devices[i]->PoolQuota > 0) {
+            return E2PROM_HeaderValueError;
+        }
+#endif
+        if (devices[i]->Config->Size < minSize) {
+            minSize = devices[i]->Config->Size;
+        }
+    }
+    if (minSize < stripeSize) {
+        return E2PROM_HeaderValueError;
+    }
+    volume->Devices    = devices;
+    volume->Count      = count;
+    volume->StripeSize = stripeSize;
+    volume->Size       = (uint32_t)(minSize / stripeSize) * stripeSize * count;
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief logical size of Volume
+ *
+ * @param volume Address of Volume Struct
+ * @return uint32_t
+ */
+uint32_t E2PROMVolume_size(E2PROMVolume* volume) {
+    return volume->Size;
+}
+
+
+
+/**
+ * @brief find device and its address for a logical address
+ *
+ * @param volume     Address of Volume Struct
+ * @param addr       logical address
+ * @param device     index of device in Devices
+ * @param deviceAddr address on the device
+ */
+void E2PROMVolume_locate(E2PROMVolume* volume, uint32_t addr, uint8_t* device, uint16_t* deviceAddr) {
+    uint32_t stripe = addr / volume->StripeSize;
+    *device     = (uint8_t)(stripe % volume->Count);
+    *deviceAddr = (uint16_t)((stripe / volume->Count) * volume->StripeSize + addr % volume->StripeSize);
+}
+
+
+
+/**
+ * @brief NonBlocking write, each stripe is queued on its device and devices program their pages in parallel
+ *        whole write is queued or nothing
+ *
+ * @param volume Address of Volume Struct
+ * @param addr   logical address
+ * @param data   Address of Data
+ * @param len    Length of Data
+ * @return E2PROM_Result E2PROM_Busy if a device has not space for its part
+ */
+E2PROM_Result E2PROMVolume_write(E2PROMVolume* volume, uint32_t addr, uint8_t* data, uint32_t len) {
+    uint32_t      bytes[E2PROMVOLUME_MAX_DEVICES]    = {0};
+    uint16_t      commands[E2PROMVOLUME_MAX_DEVICES] = {0};
+    uint32_t      pos;
+    uint16_t      chunk;
+    uint16_t      deviceAddr;
+    uint8_t       device;
+    E2PROM_Result result;
+    if (len == 0 || addr >= volume->Size || len > volume->Size - addr) {
+        return E2PROM_HeaderValueError;
+    }
+    // check space of all devices first
+    for (pos = 0; pos < len; pos += chunk) {
+        chunk = volume->StripeSize - (uint16_t)((addr + pos) % volume->StripeSize);
+        if (chunk > len - pos) {
+            chunk = (uint16_t)(len - pos);
+        }
+        E2PROMVolume_locate(volume, addr + pos, &device, &deviceAddr);
+        bytes[device] += chunk;
+        commands[device]++;
+    }
+    for (device = 0; device < volume->Count; device++) {
+        if (commands[device] > 0 &&
+            (Queue_space(&volume->Devices[device]->CommandQueue) < commands[device] ||
+             (uint32_t)Stream_space(&volume->Devices[device]->WriteStream) < bytes[device])) {
+            return E2PROM_Busy;
+        }
+    }
+    for (pos = 0; pos < len; pos += chunk) {
+        chunk = volume->StripeSize - (uint16_t)((addr + pos) % volume->StripeSize);
+        if (chunk > len - pos) {
+            chunk = (uint16_t)(len - pos);
+        }
+        E2PROMVolume_locate(volume, addr + pos, &device, &deviceAddr);
+        result = E2PROM_write(volume->Devices[device], deviceAddr, &data[pos], chunk, E2PROM_Variable);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+    }
+    return E2PROM_Ok;
+}
+
+
+
+/**
+ * @brief Blocking read, wait for queued writes of volume (E2PROM_waitForFinishProcess) before read them back
+ *
+ * @param volume Address of Volume Struct
+ * @param addr   logical address
+ * @param buffer Address of buffer
+ * @param len    Length of Data
+ * @return E2PROM_Result E2PROM_Busy if a device is in transmit, call again after E2PROM_handle
+ */
+E2PROM_Result E2PROMVolume_read(E2PROMVolume* volume, uint32_t addr, uint8_t* buffer, uint32_t len) {
+    E2PROM_Result result;
+    uint32_t      pos;
+    uint16_t      chunk;
+    uint16_t      deviceAddr;
+    uint8_t       device;
+    if (len == 0 || addr >= volume->Size || len > volume->Size - addr) {
+        return E2PROM_HeaderValueError;
+    }
+    for (pos = 0; pos < len; pos += chunk) {
+        chunk = volume->StripeSize - (uint16_t)((addr + pos) % volume->StripeSize);
+        if (chunk > len - pos) {
+            chunk = (uint16_t)(len - pos);
+        }
+        E2PROMVolume_locate(volume, addr + pos, &device, &deviceAddr);
+        // readBlocking does not read while device transmit a queued command
+        if (volume->Devices[device]->InTransmit) {
+            return E2PROM_Busy;
+        }
+        result = E2PROM_readBlocking(volume->Devices[device], deviceAddr, &buffer[pos], chunk);
+        if (result != E2PROM_Ok) {
+            return result;
+        }
+    }
+    return E2PROM_Ok;
+}
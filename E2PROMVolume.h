@@ -0,0 +1,61 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMVolume.h
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief one logical address space striped over several E2PROM devices
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+#ifndef _E2PROM_VOLUME_H_
+#define _E2PROM_VOLUME_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "E2PROM.h"
+
+/*************************************************Configuration***********************************************************/
+
+/**
+ * @brief max devices in a volume
+ */
+#define E2PROMVOLUME_MAX_DEVICES        8
+
+/**************************************************************************************************/
+
+
+
+/**
+ * @brief Volume main Struct
+ *        logical address is split to stripes of StripeSize bytes, stripe n is on device n % Count,
+ *        so a long write program pages of all devices at same time in E2PROM_handle
+ */
+typedef struct {
+    E2PROM** Devices;    /**< devices must be added with E2PROM_add and have own buffers, pooled devices are rejected */
+    uint32_t Size;       /**< logical size of volume */
+    uint16_t StripeSize; /**< better be a multiple of PageSize */
+    uint8_t  Count;
+} E2PROMVolume;
+
+
+
+E2PROM_Result E2PROMVolume_init(E2PROMVolume* volume, E2PROM** devices, uint8_t count, uint16_t stripeSize);
+uint32_t      E2PROMVolume_size(E2PROMVolume* volume);
+void          E2PROMVolume_locate(E2PROMVolume* volume, uint32_t addr, uint8_t* device, uint16_t* deviceAddr);
+E2PROM_Result E2PROMVolume_write(E2PROMVolume* volume, uint32_t addr, uint8_t* data, uint32_t len);
+E2PROM_Result E2PROMVolume_read(E2PROMVolume* volume, uint32_t addr, uint8_t* buffer, uint32_t len);
+
+#ifdef __cplusplus
+};
+#endif  // cplusplus
+
+#endif  // _E2PROM_VOLUME_H_
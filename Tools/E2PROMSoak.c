@@ -0,0 +1,733 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMSoak.c
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief host side soak and stress load generator, drive a mix of reads, writes, erases, noise erases and device add/remove
+ *        on simulated chips through public API of E2PROM, check data with a shadow model of each chip and
+ *        print throughput, queue occupancy and latency percentiles in each interval
+ *
+ *        build: gcc -O2 -I.. -I<Queue> -I<StreamBuffer> -o E2PROMSoak E2PROMSoak.c ../E2PROM.c ../E2PROMCrc.c Queue.c StreamBuffer.c
+ *        usage: E2PROMSoak [-q] [-V] [-d devices] [-t ticks] [-i interval] [-s seed] [-r rate] [-z maxLen]
+ *                          [-m write:read:erase:noise:addRemove] [-c cycleTicks] [-f readFailures]
+ *          -q  print only summary
+ *          -V  vary submission rate, each 5000 ticks rate is changed between 1/4 and 4 times of -r
+ *          -d  number of simulated devices, 1 to 4
+ *          -t  ticks of load, a tick is 1 ms of E2PROM timestamp
+ *          -i  ticks of each report interval
+ *          -s  seed of random
+ *          -r  submissions in 1000 ticks for all devices
+ *          -z  max length of writes and reads
+ *          -m  weights of operations
+ *          -c  write cycle of chip in ticks, chip NACK transfers in write cycle
+ *          -f  bus read failures in 10000 reads
+ *
+ *        exit code is 1 when data is not same as shadow, a request is lost or out of order, or a device is stalled
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "E2PROM.h"
+
+
+
+#define SOAK_MAX_DEVICES        4
+#define SOAK_CHIP_SIZE          4096
+#define SOAK_PAGE_SIZE          32
+#define SOAK_WRITE_DELAY        5
+#define SOAK_COMMANDS           16
+#define SOAK_READS              8
+#define SOAK_WRITE_STREAM       512
+#define SOAK_READ_STREAM        256
+#define SOAK_MAX_OPS            (SOAK_COMMANDS + 4)
+#define SOAK_LATENCY_BINS       8192
+#define SOAK_RATE_PHASE         5000
+#define SOAK_DRAIN_TICKS        200000
+#define SOAK_COLLAPSE           4       /**< interval with less than 1/4 of mean completions is a collapse */
+
+typedef enum {
+    OpWrite      = 0,
+    OpRead       = 1,
+    OpErase      = 2,
+    OpNoiseErase = 3,
+    OpAddRemove  = 4,
+    OpCount      = 5,
+} SoakOp;
+
+
+
+/**
+ * @brief request submitted and not completed, in order of CommandQueue
+ */
+typedef struct {
+    uint32_t Tick;
+    uint16_t Address;
+    uint16_t Len;
+    uint8_t  Op;
+    uint8_t  Expect[255];   /**< shadow of read when it is submitted */
+    uint8_t  Known[255];    /**< byte of Expect is known, noise erase make bytes unknown */
+} SoakRequest;
+
+
+
+/**
+ * @brief a simulated chip and its E2PROM
+ */
+typedef struct {
+    E2PROM        Eeprom;
+    E2PROM_Config Config;
+    uint8_t       CommandBuffer[SOAK_COMMANDS * sizeof(E2PROM_CommandHeader)];
+    uint8_t       ReadQBuffer[SOAK_READS * sizeof(E2PROM_CommandHeader)];
+    uint8_t       WriteBuffer[SOAK_WRITE_STREAM];
+    uint8_t       ReadBuffer[SOAK_READ_STREAM];
+    uint8_t       NoiseBuffer[SOAK_PAGE_SIZE * 2];
+    uint8_t       Chip[SOAK_CHIP_SIZE];
+    uint8_t       Shadow[SOAK_CHIP_SIZE];
+    uint8_t       Known[SOAK_CHIP_SIZE];
+    SoakRequest   Requests[SOAK_MAX_OPS];
+    uint8_t       Head;
+    uint8_t       Count;
+    uint8_t       Added;
+    uint8_t       Pending;      /**< IRQ of transfer is not delivered yet */
+    uint8_t       PendingRead;
+    uint32_t      PendingTick;  /**< tick of IRQ */
+    uint32_t      BusyUntil;    /**< end of write cycle of chip */
+    uint32_t      Transfers;    /**< driver calls in interval */
+} SoakDevice;
+
+
+
+typedef struct {
+    uint32_t Bins[SOAK_LATENCY_BINS + 1];
+    uint32_t Count;
+    uint32_t Max;
+} Latency;
+
+
+
+typedef struct {
+    uint64_t WriteBytes;
+    uint64_t ReadBytes;
+    uint32_t Completed;
+    uint32_t Submitted;
+    uint32_t Rejected;
+    uint64_t QueueSum;
+    uint32_t QueueSamples;
+    uint32_t QueueMax;
+    Latency  Latency;
+} Interval;
+
+
+
+static SoakDevice devices[SOAK_MAX_DEVICES];
+static uint8_t    deviceCount = 2;
+static uint32_t   now         = 1;
+static uint32_t   randState   = 1;
+static uint32_t   chipCycle   = 3;
+static uint32_t   readFailures;
+static Interval   interval;
+static Interval   total;
+
+static uint32_t   mismatches;
+static uint32_t   lost;
+static uint32_t   outOfOrder;
+static uint32_t   pageOverflows;
+static uint32_t   nacks;
+static uint32_t   failedReads;
+static uint32_t   stalls;
+static uint32_t   collapses;
+
+
+
+static uint32_t soakRand(void) {
+    randState ^= randState << 13;
+    randState ^= randState >> 17;
+    randState ^= randState << 5;
+    return randState;
+}
+
+
+
+static SoakDevice* soakDevice(E2PROM* eeprom) {
+    return (SoakDevice*)((uint8_t*)eeprom - offsetof(SoakDevice, Eeprom));
+}
+
+
+
+/**
+ * @brief device of stream of callbacks, onRead get a locked copy of ReadStream so buffer is compared
+ */
+static SoakDevice* soakStreamDevice(Stream* stream) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (Stream_getDataPtr(stream) == Stream_getDataPtr(&devices[i].Eeprom.WriteStream) ||
+            Stream_getDataPtr(stream) == Stream_getDataPtr(&devices[i].Eeprom.ReadStream)) {
+            return &devices[i];
+        }
+    }
+    return NULL;
+}
+
+
+
+/*********************************************** simulated driver ***********************************************/
+
+static E2PROM_Result soakWrite(E2PROM* eeprom, uint16_t addr, uint8_t* val, uint16_t len) {
+    SoakDevice* device = soakDevice(eeprom);
+    uint16_t    page   = addr - addr % SOAK_PAGE_SIZE;
+    device->Transfers++;
+    if (now < device->BusyUntil) {
+        // chip is in write cycle
+        nacks++;
+        return E2PROM_Error;
+    }
+    if (addr % SOAK_PAGE_SIZE + len > SOAK_PAGE_SIZE) {
+        pageOverflows++;
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        // real chips wrap to start of page
+        device->Chip[page + (addr - page + i) % SOAK_PAGE_SIZE] = val[i];
+    }
+    device->Pending     = 1;
+    device->PendingRead = 0;
+    device->PendingTick = now + 1 + len / 32;
+    device->BusyUntil   = device->PendingTick + chipCycle;
+    return E2PROM_Ok;
+}
+
+
+
+static E2PROM_Result soakRead(E2PROM* eeprom, uint16_t addr, uint8_t* buffer, uint16_t len) {
+    SoakDevice* device = soakDevice(eeprom);
+    device->Transfers++;
+    if (now < device->BusyUntil) {
+        nacks++;
+        return E2PROM_Error;
+    }
+    if (readFailures > 0 && soakRand() % 10000 < readFailures) {
+        return E2PROM_Error;
+    }
+    memcpy(buffer, &device->Chip[addr], len);
+    device->Pending     = 1;
+    device->PendingRead = 1;
+    device->PendingTick = now + 1 + len / 32;
+    return E2PROM_Ok;
+}
+
+
+
+static E2PROM_Timestamp soakTimestamp(void) {
+    return now;
+}
+
+
+
+static void soakDelayMs(E2PROM_Timestamp time) {
+    now += time;
+}
+
+
+
+static const E2PROM_Driver soakDriver = {
+    .write        = soakWrite,
+    .read         = soakRead,
+    .getTimestamp = soakTimestamp,
+    .delayMs      = soakDelayMs,
+    .rand         = soakRand,
+};
+
+
+
+/*********************************************** shadow model ***********************************************/
+
+static void latencyAdd(Latency* latency, uint32_t value) {
+    latency->Bins[value < SOAK_LATENCY_BINS ? value : SOAK_LATENCY_BINS]++;
+    latency->Count++;
+    if (value > latency->Max) {
+        latency->Max = value;
+    }
+}
+
+
+
+/**
+ * @brief latency that permille of requests are not slower than it
+ */
+static uint32_t latencyPercentile(const Latency* latency, uint32_t permille) {
+    uint64_t target = ((uint64_t)latency->Count * permille + 999) / 1000;
+    uint64_t seen   = 0;
+    for (uint32_t i = 0; i <= SOAK_LATENCY_BINS; i++) {
+        seen += latency->Bins[i];
+        if (seen >= target && seen > 0) {
+            return i < SOAK_LATENCY_BINS ? i : latency->Max;
+        }
+    }
+    return 0;
+}
+
+
+
+static void soakComplete(SoakRequest* request) {
+    uint32_t latency = now - request->Tick;
+    latencyAdd(&interval.Latency, latency);
+    latencyAdd(&total.Latency, latency);
+    interval.Completed++;
+    total.Completed++;
+    if (request->Op == OpWrite) {
+        interval.WriteBytes += request->Len;
+        total.WriteBytes    += request->Len;
+    } else if (request->Op == OpRead) {
+        interval.ReadBytes  += request->Len;
+        total.ReadBytes     += request->Len;
+    }
+}
+
+
+
+static SoakRequest* soakPush(SoakDevice* device, uint8_t op, uint16_t addr, uint16_t len) {
+    SoakRequest* request = &device->Requests[(device->Head + device->Count) % SOAK_MAX_OPS];
+    device->Count++;
+    request->Tick    = now;
+    request->Op      = op;
+    request->Address = addr;
+    request->Len     = len;
+    interval.Submitted++;
+    total.Submitted++;
+    return request;
+}
+
+
+
+/**
+ * @brief completion of a write or read, erases before it in order are done too
+ */
+static SoakRequest* soakPop(SoakDevice* device, uint8_t op, uint16_t addr, uint16_t len) {
+    SoakRequest* request;
+    while (device->Count > 0) {
+        request = &device->Requests[device->Head];
+        device->Head = (device->Head + 1) % SOAK_MAX_OPS;
+        device->Count--;
+        soakComplete(request);
+        if (request->Op == op && (op == OpRead ? request->Address == addr : request->Address + request->Len == addr + len) &&
+            (op != OpRead || request->Len == len)) {
+            return request;
+        }
+        if (request->Op != OpErase && request->Op != OpNoiseErase) {
+            outOfOrder++;
+        }
+    }
+    outOfOrder++;
+    return NULL;
+}
+
+
+
+static void onWrite(Stream* stream, uint16_t addr, uint16_t len) {
+    SoakDevice* device = soakStreamDevice(stream);
+    if (device != NULL) {
+        soakPop(device, OpWrite, addr, len);
+    }
+}
+
+
+
+static void onRead(Stream* stream, uint16_t addr, uint16_t len) {
+    SoakDevice*  device = soakStreamDevice(stream);
+    SoakRequest* request;
+    uint8_t      data[255];
+    if (device == NULL || len > sizeof(data)) {
+        return;
+    }
+    Stream_readBytes(stream, data, len);
+    request = soakPop(device, OpRead, addr, len);
+    if (request != NULL) {
+        for (uint16_t i = 0; i < len; i++) {
+            if (request->Known[i] && request->Expect[i] != data[i]) {
+                mismatches++;
+                break;
+            }
+        }
+    }
+}
+
+
+
+static void onReadError(Stream* stream, uint16_t addr, uint16_t len) {
+    SoakDevice* device = soakStreamDevice(stream);
+    if (device != NULL && soakPop(device, OpRead, addr, len) != NULL) {
+        failedReads++;
+    }
+}
+
+
+
+static void onWriteError(Stream* stream, uint16_t addr, uint16_t len) {
+    (void)stream;
+    (void)addr;
+    (void)len;
+    // device keep the page in process, request is counted as lost if it never completes
+}
+
+
+
+/**
+ * @brief device has no command in queue, in process or waiting for callback
+ */
+static uint8_t soakIdle(SoakDevice* device) {
+    return E2PROM_commandSpace(&device->Eeprom) == SOAK_COMMANDS && device->Eeprom.CommandHeaderInProcess.Len == 0 &&
+           !device->Eeprom.InTransmit && !device->Pending && Queue_available(&device->Eeprom.ReadQueue) == 0;
+}
+
+
+
+/**
+ * @brief erases have no callback, they are done when device is idle, any other request is lost
+ */
+static void soakSettle(SoakDevice* device) {
+    SoakRequest* request;
+    if (!soakIdle(device)) {
+        return;
+    }
+    while (device->Count > 0) {
+        request = &device->Requests[device->Head];
+        device->Head = (device->Head + 1) % SOAK_MAX_OPS;
+        device->Count--;
+        if (request->Op == OpErase || request->Op == OpNoiseErase) {
+            soakComplete(request);
+        } else {
+            lost++;
+        }
+    }
+}
+
+
+
+/*********************************************** load ***********************************************/
+
+static uint16_t soakLen(uint16_t maxLen) {
+    uint32_t kind = soakRand() % 100;
+    uint16_t len;
+    if (kind < 50) {
+        len = 1 + soakRand() % 8;
+    } else if (kind < 85) {
+        len = 1 + soakRand() % SOAK_PAGE_SIZE;
+    } else {
+        len = 1 + soakRand() % maxLen;
+    }
+    return len > maxLen ? maxLen : len;
+}
+
+
+
+static uint16_t soakAddress(uint16_t len) {
+    uint16_t addr = soakRand() % (SOAK_CHIP_SIZE - len + 1);
+    if (soakRand() % 100 < 40) {
+        // page aligned
+        addr -= addr % SOAK_PAGE_SIZE;
+    }
+    return addr;
+}
+
+
+
+static void soakAddRemove(void) {
+    SoakDevice* device = &devices[soakRand() % deviceCount];
+    uint8_t     added  = 0;
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        added += devices[i].Added;
+    }
+    if (!device->Added) {
+        E2PROM_add(&device->Eeprom, &device->Config);
+        device->Added = 1;
+    } else if (added > 1 && device->Count == 0 && soakIdle(device)) {
+        E2PROM_remove(&device->Eeprom);
+        device->Added = 0;
+    }
+}
+
+
+
+static void soakSubmit(const uint32_t* weights, uint16_t maxLen) {
+    static uint8_t data[SOAK_WRITE_STREAM];
+    SoakDevice*    device;
+    SoakRequest*   request;
+    uint32_t       sum  = 0;
+    uint32_t       pick;
+    uint8_t        op   = 0;
+    uint16_t       len;
+    uint16_t       addr;
+    E2PROM_Result  result;
+    for (uint8_t i = 0; i < OpCount; i++) {
+        sum += weights[i];
+    }
+    pick = soakRand() % sum;
+    while (pick >= weights[op]) {
+        pick -= weights[op++];
+    }
+    if (op == OpAddRemove) {
+        soakAddRemove();
+        return;
+    }
+    device = &devices[soakRand() % deviceCount];
+    if (!device->Added || device->Count >= SOAK_MAX_OPS) {
+        return;
+    }
+    switch (op) {
+        case OpWrite:
+            len  = soakLen(maxLen);
+            addr = soakAddress(len);
+            for (uint16_t i = 0; i < len; i++) {
+                data[i] = (uint8_t)soakRand();
+            }
+            result = E2PROM_write(&device->Eeprom, addr, data, len, E2PROM_Variable);
+            if (result == E2PROM_Ok) {
+                soakPush(device, op, addr, len);
+                memcpy(&device->Shadow[addr], data, len);
+                memset(&device->Known[addr], 1, len);
+            }
+            break;
+
+        case OpRead:
+            len  = soakLen(maxLen > 255 ? 255 : maxLen);
+            addr = soakAddress(len);
+            result = E2PROM_read(&device->Eeprom, addr, (uint8_t)len);
+            if (result == E2PROM_Ok) {
+                request = soakPush(device, op, addr, len);
+                memcpy(request->Expect, &device->Shadow[addr], len);
+                memcpy(request->Known, &device->Known[addr], len);
+            }
+            break;
+
+        case OpErase:
+            result = E2PROM_erase(&device->Eeprom);
+            if (result == E2PROM_Ok) {
+                soakPush(device, op, 0, SOAK_CHIP_SIZE);
+                memset(device->Shadow, E2PROM_DEFAULT_VALUE, SOAK_CHIP_SIZE);
+                memset(device->Known, 1, SOAK_CHIP_SIZE);
+            }
+            break;
+
+        default:
+#if E2PROM_NOISE_ERASE_NON_BLOCKING
+            result = E2PROM_noiseErase(&device->Eeprom);
+            if (result == E2PROM_Ok) {
+                soakPush(device, op, 0, SOAK_CHIP_SIZE);
+                memset(device->Known, 0, SOAK_CHIP_SIZE);
+            }
+#else
+            result = E2PROM_Ok;
+#endif
+            break;
+    }
+    if (result == E2PROM_Busy) {
+        interval.Rejected++;
+        total.Rejected++;
+    }
+}
+
+
+
+/**
+ * @brief one tick of simulation, deliver IRQs that are due and run handle
+ */
+static void soakTick(void) {
+    SoakDevice* device;
+    uint32_t    queued;
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        device = &devices[i];
+        if (device->Pending && now >= device->PendingTick) {
+            device->Pending = 0;
+            if (device->PendingRead) {
+                E2PROM_readIRQ(&device->Eeprom);
+            } else {
+                E2PROM_writeIRQ(&device->Eeprom);
+            }
+        }
+    }
+    E2PROM_handle();
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        device = &devices[i];
+        soakSettle(device);
+        if (device->Added) {
+            queued = SOAK_COMMANDS - E2PROM_commandSpace(&device->Eeprom);
+            interval.QueueSum += queued;
+            interval.QueueSamples++;
+            if (queued > interval.QueueMax) {
+                interval.QueueMax = queued;
+            }
+        }
+    }
+    now++;
+}
+
+
+
+/**
+ * @brief print interval, find stalled devices and collapse of throughput
+ */
+static void soakReport(uint32_t ticks, uint8_t quiet, uint32_t* intervals, uint64_t* completedSum) {
+    SoakDevice* device;
+    uint64_t    mean = *intervals > 0 ? *completedSum / *intervals : 0;
+    uint8_t     collapse = 0;
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        device = &devices[i];
+        if (device->Count > 0 && device->Transfers == 0) {
+            stalls++;
+            if (!quiet) {
+                printf("  device %u stalled with %u requests\n", i, device->Count);
+            }
+        }
+        device->Transfers = 0;
+    }
+    if (*intervals >= 3 && interval.Completed * SOAK_COLLAPSE < mean && interval.Submitted > 0) {
+        collapses++;
+        collapse = 1;
+    }
+    if (!quiet) {
+        printf("t=%8u ops=%6u sub=%6u rej=%6u wKB/s=%8.2f rKB/s=%8.2f q=%5.2f/%-3u lat p50=%u p90=%u p99=%u max=%u%s\n",
+               now, interval.Completed, interval.Submitted, interval.Rejected,
+               interval.WriteBytes * 1000.0 / 1024 / ticks, interval.ReadBytes * 1000.0 / 1024 / ticks,
+               interval.QueueSamples ? (double)interval.QueueSum / interval.QueueSamples : 0.0, interval.QueueMax,
+               latencyPercentile(&interval.Latency, 500), latencyPercentile(&interval.Latency, 900),
+               latencyPercentile(&interval.Latency, 990), interval.Latency.Max, collapse ? " COLLAPSE" : "");
+    }
+    (*intervals)++;
+    *completedSum += interval.Completed;
+    memset(&interval, 0, sizeof(interval));
+}
+
+
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [-q] [-V] [-d devices] [-t ticks] [-i interval] [-s seed] [-r rate] [-z maxLen]\n"
+                    "          [-m write:read:erase:noise:addRemove] [-c cycleTicks] [-f readFailures]\n", name);
+    exit(2);
+}
+
+
+
+int main(int argc, char* argv[]) {
+    uint32_t weights[OpCount] = {600, 380, 2, 2, 16};
+    uint32_t ticks            = 100000;
+    uint32_t reportTicks      = 1000;
+    uint32_t rate             = 400;
+    uint32_t phaseRate;
+    uint32_t credit           = 0;
+    uint32_t intervals        = 0;
+    uint64_t completedSum     = 0;
+    uint32_t end;
+    uint32_t badBytes         = 0;
+    uint16_t maxLen           = 96;
+    uint8_t  quiet            = 0;
+    uint8_t  vary             = 0;
+    int      opt;
+    while ((opt = getopt(argc, argv, "qVd:t:i:s:r:z:m:c:f:")) != -1) {
+        switch (opt) {
+            case 'q': quiet        = 1; break;
+            case 'V': vary         = 1; break;
+            case 'd': deviceCount  = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case 't': ticks        = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': reportTicks  = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': randState    = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': rate         = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'z': maxLen       = (uint16_t)strtoul(optarg, NULL, 0); break;
+            case 'c': chipCycle    = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'f': readFailures = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'm':
+                if (sscanf(optarg, "%u:%u:%u:%u:%u", &weights[0], &weights[1], &weights[2], &weights[3], &weights[4]) != OpCount) {
+                    usage(argv[0]);
+                }
+                break;
+            default:  usage(argv[0]);
+        }
+    }
+    if (optind != argc || deviceCount == 0 || deviceCount > SOAK_MAX_DEVICES || reportTicks == 0 || randState == 0 ||
+        maxLen == 0 || maxLen > SOAK_WRITE_STREAM || weights[0] + weights[1] + weights[2] + weights[3] + weights[4] == 0) {
+        usage(argv[0]);
+    }
+
+    E2PROM_driverInit(&soakDriver);
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        SoakDevice* device = &devices[i];
+        device->Config.WriteDelayTime = SOAK_WRITE_DELAY;
+        device->Config.Size           = SOAK_CHIP_SIZE;
+        device->Config.PageSize       = SOAK_PAGE_SIZE;
+        device->Config.DeviceId       = 0xA0 | (i << 1);
+        E2PROM_init(&device->Eeprom, device->CommandBuffer, sizeof(device->CommandBuffer), device->ReadQBuffer, sizeof(device->ReadQBuffer),
+                    device->WriteBuffer, sizeof(device->WriteBuffer), device->ReadBuffer, sizeof(device->ReadBuffer));
+#if E2PROM_NOISE_ERASE_NON_BLOCKING
+        E2PROM_noiseEraseInit(&device->Eeprom, device->NoiseBuffer, sizeof(device->NoiseBuffer));
+#endif
+        E2PROM_onWrite(&device->Eeprom, onWrite);
+        E2PROM_onRead(&device->Eeprom, onRead);
+        E2PROM_onReadError(&device->Eeprom, onReadError);
+        E2PROM_onWriteError(&device->Eeprom, onWriteError);
+        E2PROM_add(&device->Eeprom, &device->Config);
+        device->Added = 1;
+        memset(device->Chip, E2PROM_DEFAULT_VALUE, SOAK_CHIP_SIZE);
+        memset(device->Shadow, E2PROM_DEFAULT_VALUE, SOAK_CHIP_SIZE);
+        memset(device->Known, 1, SOAK_CHIP_SIZE);
+    }
+
+    // load
+    phaseRate = rate;
+    end       = now + ticks;
+    while (now < end) {
+        if (vary && now % SOAK_RATE_PHASE == 0) {
+            phaseRate = rate / 4 + soakRand() % (rate * 4 - rate / 4 + 1);
+        }
+        credit += phaseRate;
+        while (credit >= 1000) {
+            credit -= 1000;
+            soakSubmit(weights, maxLen);
+        }
+        soakTick();
+        if (now % reportTicks == 0) {
+            soakReport(reportTicks, quiet, &intervals, &completedSum);
+        }
+    }
+
+    // drain, every request must complete
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (!devices[i].Added) {
+            E2PROM_add(&devices[i].Eeprom, &devices[i].Config);
+            devices[i].Added = 1;
+        }
+    }
+    end = now + SOAK_DRAIN_TICKS;
+    while (now < end) {
+        uint32_t left = 0;
+        for (uint8_t i = 0; i < deviceCount; i++) {
+            left += devices[i].Count;
+        }
+        if (left == 0) {
+            break;
+        }
+        soakTick();
+    }
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        lost += devices[i].Count;
+        for (uint16_t addr = 0; addr < SOAK_CHIP_SIZE; addr++) {
+            if (devices[i].Known[addr] && devices[i].Chip[addr] != devices[i].Shadow[addr]) {
+                badBytes++;
+            }
+        }
+    }
+
+    printf("ticks=%u devices=%u submitted=%u completed=%u rejected=%u\n", ticks, deviceCount, total.Submitted, total.Completed, total.Rejected);
+    printf("write %.2f KB/s read %.2f KB/s latency p50=%u p90=%u p99=%u p99.9=%u max=%u ticks\n",
+           total.WriteBytes * 1000.0 / 1024 / ticks, total.ReadBytes * 1000.0 / 1024 / ticks,
+           latencyPercentile(&total.Latency, 500), latencyPercentile(&total.Latency, 900), latencyPercentile(&total.Latency, 990),
+           latencyPercentile(&total.Latency, 999), total.Latency.Max);
+    printf("mismatched reads=%u bad bytes=%u lost=%u out of order=%u stalls=%u collapses=%u\n",
+           mismatches, badBytes, lost, outOfOrder, stalls, collapses);
+    printf("page overflows=%u nacks=%u failed reads=%u\n", pageOverflows, nacks, failedReads);
+    return (mismatches || badBytes || lost || outOfOrder || stalls || pageOverflows) ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/** In the Nama of God */
+/**
+ * @file E2PROMTraceDecoder.c
+ * @author Reza Dehghan (Rezzadehghgan98@gmail.com)
+ * @brief host side decoder of E2PROM_traceDump output, print timeline, bus utilisation and gaps of each device
+ *
+ *        build: gcc -O2 -o E2PROMTraceDecoder E2PROMTraceDecoder.c
+ *        usage: E2PROMTraceDecoder [-q] [-w writeCycleTicks] [-p pageSize] trace.bin
+ *          -q  do not print timeline
+ *          -w  expected write cycle of chip in ticks, idle time after a program beyond this is wasted
+ *          -p  page size of chip, programs shorter than a page are counted as partial
+ * @version 0.1
+ * @date 2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+
+#define TRACE_VERSION           1
+#define TRACE_HEADER_SIZE       8
+#define TRACE_RECORD_SIZE       12
+#define TRACE_MAX_DEVICES       256
+
+/* same values of E2PROM_TraceEvent */
+#define EVENT_WRITE             0x00
+#define EVENT_READ              0x01
+#define EVENT_WRITE_IRQ         0x02
+#define EVENT_READ_IRQ          0x03
+#define EVENT_BLOCKING          0x80
+
+
+
+typedef struct {
+    uint32_t Timestamp;
+    uint16_t Address;
+    uint16_t Len;
+    uint8_t  Device;
+    uint8_t  Mode;
+    uint8_t  Event;
+    uint8_t  Result;
+} TraceRecord;
+
+
+
+typedef struct {
+    uint64_t Min;
+    uint64_t Max;
+    uint64_t Sum;
+    uint64_t Wasted;
+    uint32_t Count;
+} GapStat;
+
+
+
+typedef struct {
+    uint64_t Busy;
+    uint32_t CallTime;      /**< time of driver call not completed yet */
+    uint32_t IdleTime;      /**< time of last completion */
+    uint32_t Writes;
+    uint32_t PartialWrites;
+    uint32_t Reads;
+    uint32_t Errors;
+    uint32_t WriteBytes;
+    uint32_t ReadBytes;
+    GapStat  AfterWrite;
+    GapStat  AfterRead;
+    uint8_t  InCall;
+    uint8_t  LastEvent;     /**< event of last completion */
+    uint8_t  Idle;          /**< a completion seen and no call after it */
+    uint8_t  Used;
+} DeviceStat;
+
+
+
+static const char* EVENT_NAMES[] = { "write", "read", "writeIRQ", "readIRQ" };
+static const char* MODE_NAMES[]  = { "read", "write", "erase", "noise" };
+
+
+
+static uint16_t readU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t readU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void gapAdd(GapStat* gap, uint64_t value, uint64_t allowed) {
+    if (gap->Count == 0 || value < gap->Min) {
+        gap->Min = value;
+    }
+    if (value > gap->Max) {
+        gap->Max = value;
+    }
+    gap->Sum    += value;
+    gap->Wasted += value > allowed ? value - allowed : 0;
+    gap->Count++;
+}
+
+static void gapPrint(const char* name, const GapStat* gap) {
+    if (gap->Count == 0) {
+        printf("  gaps after %-5s : none\n", name);
+        return;
+    }
+    printf("  gaps after %-5s : n=%u min=%llu avg=%llu max=%llu wasted=%llu ticks\n", name, gap->Count,
+           (unsigned long long)gap->Min, (unsigned long long)(gap->Sum / gap->Count),
+           (unsigned long long)gap->Max, (unsigned long long)gap->Wasted);
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [-q] [-w writeCycleTicks] [-p pageSize] trace.bin\n", name);
+    exit(2);
+}
+
+
+
+int main(int argc, char* argv[]) {
+    static DeviceStat devices[TRACE_MAX_DEVICES];
+    uint8_t           header[TRACE_HEADER_SIZE];
+    uint8_t           raw[TRACE_RECORD_SIZE];
+    TraceRecord       record;
+    DeviceStat*       device;
+    FILE*             file;
+    uint32_t          writeCycle = 0;
+    uint32_t          pageSize   = 0;
+    uint32_t          first      = 0;
+    uint32_t          last       = 0;
+    uint32_t          prev       = 0;
+    uint16_t          count;
+    uint8_t           event;
+    int               quiet = 0;
+    int               opt;
+
+    while ((opt = getopt(argc, argv, "qw:p:")) != -1) {
+        switch (opt) {
+            case 'q': quiet      = 1; break;
+            case 'w': writeCycle = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'p': pageSize   = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:  usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+    }
+    file = fopen(argv[optind], "rb");
+    if (file == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, "E2TR", 4) != 0) {
+        fprintf(stderr, "%s: not an E2PROM trace\n", argv[optind]);
+        return 1;
+    }
+    if (header[4] != TRACE_VERSION || header[5] != TRACE_RECORD_SIZE) {
+        fprintf(stderr, "%s: unsupported trace version %u, record size %u\n", argv[optind], header[4], header[5]);
+        return 1;
+    }
+    count = readU16(&header[6]);
+
+    if (!quiet) {
+        printf("%10s %8s %4s %-10s %-6s %6s %5s %3s\n", "time", "dt", "dev", "event", "mode", "addr", "len", "res");
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (fread(raw, 1, sizeof(raw), file) != sizeof(raw)) {
+            fprintf(stderr, "%s: truncated after %u records\n", argv[optind], i);
+            break;
+        }
+        record.Timestamp = readU32(&raw[0]);
+        record.Address   = readU16(&raw[4]);
+        record.Len       = readU16(&raw[6]);
+        record.Device    = raw[8];
+        record.Mode      = raw[9];
+        record.Event     = raw[10];
+        record.Result    = raw[11];
+        event            = record.Event & ~EVENT_BLOCKING;
+
+        if (i == 0) {
+            first = record.Timestamp;
+            prev  = record.Timestamp;
+        }
+        last = record.Timestamp;
+        if (!quiet) {
+            printf("%10u %8u %4u %-10s %-6s %6u %5u %3u%s\n", record.Timestamp, record.Timestamp - prev, record.Device,
+                   event < 4 ? EVENT_NAMES[event] : "?", record.Mode < 4 ? MODE_NAMES[record.Mode] : "?",
+                   record.Address, record.Len, record.Result, (record.Event & EVENT_BLOCKING) ? " blocking" : "");
+        }
+        prev = record.Timestamp;
+
+        device       = &devices[record.Device];
+        device->Used = 1;
+        switch (event) {
+            case EVENT_WRITE:
+            case EVENT_READ:
+                if (device->Idle) {
+                    gapAdd(device->LastEvent == EVENT_WRITE_IRQ ? &device->AfterWrite : &device->AfterRead,
+                           record.Timestamp - device->IdleTime,
+                           device->LastEvent == EVENT_WRITE_IRQ ? writeCycle : 0);
+                    device->Idle = 0;
+                }
+                if (record.Result != 0) {
+                    device->Errors++;
+                    break;
+                }
+                if (event == EVENT_WRITE) {
+                    device->Writes++;
+                    device->WriteBytes += record.Len;
+                    if (pageSize > 0 && record.Len < pageSize) {
+                        device->PartialWrites++;
+                    }
+                } else {
+                    device->Reads++;
+                    device->ReadBytes += record.Len;
+                }
+                device->InCall   = 1;
+                device->CallTime = record.Timestamp;
+                break;
+
+            case EVENT_WRITE_IRQ:
+            case EVENT_READ_IRQ:
+                if (device->InCall) {
+                    device->Busy  += record.Timestamp - device->CallTime;
+                    device->InCall = 0;
+                }
+                device->Idle      = 1;
+                device->IdleTime  = record.Timestamp;
+                device->LastEvent = event;
+                break;
+        }
+    }
+    fclose(file);
+
+    printf("\n%u records, span %u ticks\n", count, last - first);
+    for (uint32_t dev = 0; dev < TRACE_MAX_DEVICES; dev++) {
+        device = &devices[dev];
+        if (!device->Used) {
+            continue;
+        }
+        printf("device %u: bus busy %llu ticks (%.1f%%)\n", dev, (unsigned long long)device->Busy,
+               last > first ? 100.0 * (double)device->Busy / (double)(last - first) : 0.0);
+        printf("  writes %u (%u bytes, %u partial page), reads %u (%u bytes), errors %u\n",
+               device->Writes, device->WriteBytes, device->PartialWrites, device->Reads, device->ReadBytes, device->Errors);
+        gapPrint("write", &device->AfterWrite);
+        gapPrint("read", &device->AfterRead);
+    }
+    return 0;
+}